@@ -59,6 +59,21 @@ Return<void> GnssDebug::getDebugData(getDebugData_cb _hidl_cb)
     GnssDebugReport reports = { };
     mGnss->getGnssInterface()->getDebugReport(reports);
 
+    // DebugData has no room for it, so adapter thread queue stats go to the
+    // debug log; the report only carries them at that log level
+    IF_LOC_LOGD {
+        size_t start = 0;
+        while (start < reports.mMsgTaskStats.size()) {
+            size_t end = reports.mMsgTaskStats.find('\n', start);
+            if (std::string::npos == end) {
+                end = reports.mMsgTaskStats.size();
+            }
+            LOC_LOGD("%s]: %s", __func__,
+                     reports.mMsgTaskStats.substr(start, end - start).c_str());
+            start = end + 1;
+        }
+    }
+
     // location block
     if (reports.mLocation.mValid) {
         data.position.valid = true;
@@ -133,7 +133,10 @@ public:
     inline IzatDevId_t getIzatDevId() const {
         return mLBSProxy->getIzatDevId();
     }
-    inline void sendMsg(const LocMsg *msg) { getMsgTask()->sendMsg(msg); }
+    inline void sendMsg(const LocMsg *msg,
+                        LocMsgPriority priority = LOC_MSG_PRIORITY_DEFAULT) {
+        getMsgTask()->sendMsg(msg, priority);
+    }
 
     static loc_gps_cfg_s_type mGps_conf;
     static loc_sap_cfg_s_type mSap_conf;
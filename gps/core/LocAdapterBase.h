@@ -61,17 +61,21 @@ private:
     static uint32_t mSessionIdCounter;
 protected:
     LOC_API_ADAPTER_EVENT_MASK_T mEvtMask;
+    // reports the adapter passes on (e.g. to ULP) whether or not its own
+    // clients registered for them, so it is routed them regardless
+    const LOC_API_ADAPTER_EVENT_MASK_T mForwardedMask;
     ContextBase* mContext;
     LocApiBase* mLocApi;
     LocAdapterProxyBase* mLocAdapterProxyBase;
     const MsgTask* mMsgTask;
     inline LocAdapterBase(const MsgTask* msgTask) :
-        mEvtMask(0), mContext(NULL), mLocApi(NULL),
+        mEvtMask(0), mForwardedMask(0), mContext(NULL), mLocApi(NULL),
         mLocAdapterProxyBase(NULL), mMsgTask(msgTask) {}
 public:
     inline virtual ~LocAdapterBase() { mLocApi->removeAdapter(this); }
     LocAdapterBase(const LOC_API_ADAPTER_EVENT_MASK_T mask,
-                   ContextBase* context, LocAdapterProxyBase *adapterProxyBase = NULL);
+                   ContextBase* context, LocAdapterProxyBase *adapterProxyBase = NULL,
+                   const LOC_API_ADAPTER_EVENT_MASK_T forwardedMask = 0);
     inline LOC_API_ADAPTER_EVENT_MASK_T
         checkMask(LOC_API_ADAPTER_EVENT_MASK_T mask) const {
         return mEvtMask & mask;
@@ -81,12 +85,19 @@ public:
         return mEvtMask;
     }
 
-    inline void sendMsg(const LocMsg* msg) const {
-        mMsgTask->sendMsg(msg);
+    // the reports LocApiBase routes to this adapter
+    inline LOC_API_ADAPTER_EVENT_MASK_T getRouteMask() const {
+        return mEvtMask | mForwardedMask;
     }
 
-    inline void sendMsg(const LocMsg* msg) {
-        mMsgTask->sendMsg(msg);
+    inline void sendMsg(const LocMsg* msg,
+                        LocMsgPriority priority = LOC_MSG_PRIORITY_DEFAULT) const {
+        mMsgTask->sendMsg(msg, priority);
+    }
+
+    inline void sendMsg(const LocMsg* msg,
+                        LocMsgPriority priority = LOC_MSG_PRIORITY_DEFAULT) {
+        mMsgTask->sendMsg(msg, priority);
     }
 
     inline void updateEvtMask(LOC_API_ADAPTER_EVENT_MASK_T event,
@@ -40,6 +40,29 @@ namespace loc_core {
 
 #define TO_ALL_LOCADAPTERS(call) TO_ALL_ADAPTERS(mLocAdapters, (call))
 #define TO_1ST_HANDLING_LOCADAPTERS(call) TO_1ST_HANDLING_ADAPTER(mLocAdapters, (call))
+#define TO_ROUTED_LOCADAPTERS(route, call)                                   \
+    {                                                                        \
+        std::shared_ptr<const LocApiRoutes> routes(std::atomic_load(&mRoutes)); \
+        LocAdapterBase* const* adapters = routes->mAdapters[(route)];       \
+        TO_ALL_ADAPTERS(adapters, (call));                                   \
+    }
+
+// the event mask bits that subscribe an adapter to each route
+static const LOC_API_ADAPTER_EVENT_MASK_T sRouteMasks[LOC_API_ROUTE_MAX] =
+{
+    // LOC_API_ROUTE_POSITION
+    LOC_API_ADAPTER_BIT_PARSED_POSITION_REPORT,
+    // LOC_API_ROUTE_SV
+    LOC_API_ADAPTER_BIT_SATELLITE_REPORT,
+    // LOC_API_ROUTE_NMEA
+    LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT | LOC_API_ADAPTER_BIT_NMEA_POSITION_REPORT,
+    // LOC_API_ROUTE_SV_MEASUREMENT
+    LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT_REPORT | LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT,
+    // LOC_API_ROUTE_SV_POLYNOMIAL
+    LOC_API_ADAPTER_BIT_GNSS_SV_POLYNOMIAL_REPORT,
+    // LOC_API_ROUTE_GNSS_MEASUREMENT
+    LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT_REPORT | LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT
+};
 
 int hexcode(char *hexstring, int string_size,
             const char *data, int data_size)
@@ -134,6 +157,8 @@ LocApiBase::LocApiBase(const MsgTask* msgTask,
 {
     memset(mLocAdapters, 0, sizeof(mLocAdapters));
     memset(mFeaturesSupported, 0, sizeof(mFeaturesSupported));
+    pthread_mutex_init(&mRoutesMutex, NULL);
+    updateRoutes();
 }
 
 LOC_API_ADAPTER_EVENT_MASK_T LocApiBase::getEvtMask()
@@ -145,6 +170,28 @@ LOC_API_ADAPTER_EVENT_MASK_T LocApiBase::getEvtMask()
     return mask & ~mExcludedMask;
 }
 
+void LocApiBase::updateRoutes()
+{
+    std::shared_ptr<LocApiRoutes> routes = std::make_shared<LocApiRoutes>();
+    memset(routes->mAdapters, 0, sizeof(routes->mAdapters));
+
+    // the last rebuild to take the lock reads the latest adapters and
+    // masks, so it is also the last one stored
+    pthread_mutex_lock(&mRoutesMutex);
+
+    for (int route = 0; route < LOC_API_ROUTE_MAX; route++) {
+        int count = 0;
+        for (int i = 0; i < MAX_ADAPTERS && NULL != mLocAdapters[i]; i++) {
+            if (mLocAdapters[i]->getRouteMask() & sRouteMasks[route]) {
+                routes->mAdapters[route][count++] = mLocAdapters[i];
+            }
+        }
+    }
+
+    std::atomic_store(&mRoutes, std::shared_ptr<const LocApiRoutes>(routes));
+    pthread_mutex_unlock(&mRoutesMutex);
+}
+
 bool LocApiBase::isInSession()
 {
     bool inSession = false;
@@ -163,6 +210,7 @@ void LocApiBase::addAdapter(LocAdapterBase* adapter)
     for (int i = 0; i < MAX_ADAPTERS && mLocAdapters[i] != adapter; i++) {
         if (mLocAdapters[i] == NULL) {
             mLocAdapters[i] = adapter;
+            updateRoutes();
             mMsgTask->sendMsg(new LocOpenMsg(this,
                                              (adapter->getEvtMask())));
             break;
@@ -194,6 +242,7 @@ void LocApiBase::removeAdapter(LocAdapterBase* adapter)
             mLocAdapters[j] = mLocAdapters[i];
             // this makes sure that we exit the for loop
             mLocAdapters[i] = NULL;
+            updateRoutes();
 
             // if we have an empty list of adapters
             if (0 == i) {
@@ -208,6 +257,7 @@ void LocApiBase::removeAdapter(LocAdapterBase* adapter)
 
 void LocApiBase::updateEvtMask()
 {
+    updateRoutes();
     mMsgTask->sendMsg(new LocOpenMsg(this, getEvtMask()));
 }
 
@@ -251,10 +301,10 @@ void LocApiBase::reportPosition(UlpLocation& location,
              locationExtended.gnss_sv_used_ids.bds_sv_used_ids_mask,
              locationExtended.gnss_sv_used_ids.gal_sv_used_ids_mask,
              locationExtended.gnss_sv_used_ids.qzss_sv_used_ids_mask);
-    // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportPositionEvent(location, locationExtended,
-                                             status, loc_technology_mask)
+    // deliver to the adapters registered for positions.
+    TO_ROUTED_LOCADAPTERS(LOC_API_ROUTE_POSITION,
+        adapters[i]->reportPositionEvent(location, locationExtended,
+                                         status, loc_technology_mask)
     );
 }
 
@@ -289,25 +339,25 @@ void LocApiBase::reportSv(GnssSvNotification& svNotify)
             svNotify.gnssSvs[i].azimuth,
             svNotify.gnssSvs[i].gnssSvOptionsMask);
     }
-    // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportSvEvent(svNotify)
+    // deliver to the adapters registered for SVs.
+    TO_ROUTED_LOCADAPTERS(LOC_API_ROUTE_SV,
+        adapters[i]->reportSvEvent(svNotify)
         );
 }
 
 void LocApiBase::reportSvMeasurement(GnssSvMeasurementSet &svMeasurementSet)
 {
-    // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportSvMeasurementEvent(svMeasurementSet)
+    // deliver to the adapters registered for measurements.
+    TO_ROUTED_LOCADAPTERS(LOC_API_ROUTE_SV_MEASUREMENT,
+        adapters[i]->reportSvMeasurementEvent(svMeasurementSet)
     );
 }
 
 void LocApiBase::reportSvPolynomial(GnssSvPolynomial &svPolynomial)
 {
-    // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportSvPolynomialEvent(svPolynomial)
+    // deliver to the adapters registered for SV polynomials.
+    TO_ROUTED_LOCADAPTERS(LOC_API_ROUTE_SV_POLYNOMIAL,
+        adapters[i]->reportSvPolynomialEvent(svPolynomial)
     );
 }
 
@@ -319,8 +369,8 @@ void LocApiBase::reportStatus(LocGpsStatusValue status)
 
 void LocApiBase::reportNmea(const char* nmea, int length)
 {
-    // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportNmeaEvent(nmea, length));
+    // deliver to the adapters registered for NMEA.
+    TO_ROUTED_LOCADAPTERS(LOC_API_ROUTE_NMEA, adapters[i]->reportNmeaEvent(nmea, length));
 }
 
 void LocApiBase::reportXtraServer(const char* url1, const char* url2,
@@ -404,8 +454,9 @@ LocApiProxyBase* LocApiBase :: getLocApiProxy()
 void LocApiBase::reportGnssMeasurementData(GnssMeasurementsNotification& measurements,
                                            int msInWeek)
 {
-    // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportGnssMeasurementDataEvent(measurements, msInWeek));
+    // deliver to the adapters registered for measurements.
+    TO_ROUTED_LOCADAPTERS(LOC_API_ROUTE_GNSS_MEASUREMENT,
+        adapters[i]->reportGnssMeasurementDataEvent(measurements, msInWeek));
 }
 
 enum loc_api_adapter_err LocApiBase::
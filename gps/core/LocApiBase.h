@@ -31,6 +31,8 @@
 
 #include <stddef.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <memory>
 #include <gps_extended.h>
 #include <LocationAPI.h>
 #include <MsgTask.h>
@@ -55,6 +57,18 @@ int decodeAddress(char *addr_string, int string_size,
 #define TO_1ST_HANDLING_ADAPTER(adapters, call)                              \
     for (int i = 0; i <MAX_ADAPTERS && NULL != (adapters)[i] && !(call); i++);
 
+// The frequent reports, each delivered only to the adapters whose route
+// mask (see LocAdapterBase::getRouteMask) has one of the bits of the report
+enum LocApiRoute {
+    LOC_API_ROUTE_POSITION = 0,
+    LOC_API_ROUTE_SV,
+    LOC_API_ROUTE_NMEA,
+    LOC_API_ROUTE_SV_MEASUREMENT,
+    LOC_API_ROUTE_SV_POLYNOMIAL,
+    LOC_API_ROUTE_GNSS_MEASUREMENT,
+    LOC_API_ROUTE_MAX
+};
+
 enum xtra_version_check {
     DISABLED,
     AUTO,
@@ -66,6 +80,11 @@ class LocAdapterBase;
 struct LocSsrMsg;
 struct LocOpenMsg;
 
+// the adapters of each route, without holes, like mLocAdapters
+struct LocApiRoutes {
+    LocAdapterBase* mAdapters[LOC_API_ROUTE_MAX][MAX_ADAPTERS];
+};
+
 class LocApiProxyBase {
 public:
     inline LocApiProxyBase() {}
@@ -82,6 +101,11 @@ class LocApiBase {
     const MsgTask* mMsgTask;
     ContextBase *mContext;
     LocAdapterBase* mLocAdapters[MAX_ADAPTERS];
+    // rebuilt from mLocAdapters whenever an adapter or its event mask
+    // changes, only accessed with std::atomic_load and std::atomic_store
+    std::shared_ptr<const LocApiRoutes> mRoutes;
+    // serializes the rebuilds, which run on the callers' threads
+    pthread_mutex_t mRoutesMutex;
     uint64_t mSupportedMsg;
     uint8_t mFeaturesSupported[MAX_FEATURE_LENGTH];
 
@@ -95,8 +119,12 @@ protected:
     LocApiBase(const MsgTask* msgTask,
                LOC_API_ADAPTER_EVENT_MASK_T excludedMask,
                ContextBase* context = NULL);
-    inline virtual ~LocApiBase() { close(); }
+    inline virtual ~LocApiBase() {
+        close();
+        pthread_mutex_destroy(&mRoutesMutex);
+    }
     bool isInSession();
+    void updateRoutes();
     const LOC_API_ADAPTER_EVENT_MASK_T mExcludedMask;
 
 public:
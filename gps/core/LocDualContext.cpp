@@ -70,7 +70,11 @@ const MsgTask* LocDualContext::getMsgTask(LocThread::tCreate tCreator,
                                           const char* name, bool joinable)
 {
     if (NULL == mMsgTask) {
-        mMsgTask = new MsgTask(tCreator, name, joinable);
+        // the adapter thread is fed from the QMI callback thread(s) and
+        // every client thread, so keep its senders off any mutex, and
+        // drain whatever piled up in one go
+        mMsgTask = new MsgTask(tCreator, name, joinable,
+                               /* lockFreeQ */ true, /* batchDrain */ true);
     }
     return mMsgTask;
 }
@@ -29,13 +29,16 @@
 #define LOG_TAG "LocSvc_SystemStatus"
 
 #include <inttypes.h>
+#include <ctype.h>
 #include <string>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include <pthread.h>
 #include <platform_lib_log_util.h>
+#include <platform_lib_includes.h>
 #include <MsgTask.h>
+#include <loc_cfg.h>
 #include <loc_nmea.h>
 #include <SystemStatus.h>
 #include <SystemStatusOsObserver.h>
@@ -49,40 +52,163 @@ namespace loc_core
 class SystemStatusNmeaBase
 {
 protected:
-    std::vector<std::string> mField;
+    enum
+    {
+        // the most fields of all the sentences, PQWP7
+        NMEA_FIELDS_MAX = 2 + SV_ALL_NUM*3
+    };
 
-    SystemStatusNmeaBase(const char *str_in, uint32_t len_in)
+    // The fields are not copied out of the sentence, field i is the text
+    // from mData + mFieldStart[i] up to the separator before the next one.
+    const char *mData;
+    uint32_t   mFieldCount;
+    uint16_t   mFieldStart[NMEA_FIELDS_MAX + 1];
+
+    static inline int hexDigit(char c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return -1;
+    }
+
+    // Splits the sentence up to its '*' in one pass, computing the checksum
+    // on the way. A sentence with no or a mismatching checksum has no fields.
+    SystemStatusNmeaBase(const char *str_in, uint32_t len_in) :
+        mData(str_in), mFieldCount(0)
     {
         // check size and talker
         if (!loc_nmea_is_debug(str_in, len_in)) {
             return;
         }
 
-        std::string parser(str_in);
-        std::string::size_type index = 0;
-
-        // verify checksum field
-        index = parser.find("*");
-        if (index == std::string::npos) {
-            return;
-        }
-        parser[index] = ',';
-
-        // tokenize parser
-        while (1) {
-            std::string str;
-            index = parser.find(",");
-            if (index == std::string::npos) {
-                break;
+        uint32_t fieldCount = 0;
+        uint8_t checksum = 0;
+        mFieldStart[0] = 0;
+        for (uint32_t i = 1; i < len_in && '\0' != str_in[i]; i++) {
+            char c = str_in[i];
+            if ('*' == c) {
+                // verify checksum field
+                int high = (i + 2 < len_in) ? hexDigit(str_in[i + 1]) : -1;
+                int low = (high >= 0) ? hexDigit(str_in[i + 2]) : -1;
+                if (low < 0 || ((high << 4) | low) != checksum) {
+                    LOC_LOGE("NmeaBase - invalid checksum %.6s", str_in);
+                    return;
+                }
+                if (fieldCount < NMEA_FIELDS_MAX) {
+                    mFieldStart[++fieldCount] = i + 1;
+                }
+                mFieldCount = fieldCount;
+                return;
             }
-            str = parser.substr(0, index);
-            parser = parser.substr(index + 1);
-            mField.push_back(str);
+            if (',' == c && fieldCount < NMEA_FIELDS_MAX) {
+                mFieldStart[++fieldCount] = i + 1;
+            }
+            checksum ^= c;
         }
     }
 
     virtual ~SystemStatusNmeaBase() { }
 
+    inline const char* fieldBegin(uint32_t i) const { return mData + mFieldStart[i]; }
+    inline const char* fieldEnd(uint32_t i) const { return mData + mFieldStart[i + 1] - 1; }
+
+    // decimal integer of field i, as atoi() would parse it
+    int32_t getInt(uint32_t i) const
+    {
+        const char *p = fieldBegin(i);
+        const char *end = fieldEnd(i);
+        while (p < end && isspace(*p)) {
+            p++;
+        }
+        bool negative = false;
+        if (p < end && ('-' == *p || '+' == *p)) {
+            negative = ('-' == *p);
+            p++;
+        }
+        uint32_t value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            value = value * 10 + (*p - '0');
+        }
+        return (int32_t)(negative ? (0 - value) : value);
+    }
+
+    // hex integer of field i, as strtol(, , 16) would parse it
+    uint64_t getHex(uint32_t i) const
+    {
+        const char *p = fieldBegin(i);
+        const char *end = fieldEnd(i);
+        while (p < end && isspace(*p)) {
+            p++;
+        }
+        bool negative = false;
+        if (p < end && ('-' == *p || '+' == *p)) {
+            negative = ('-' == *p);
+            p++;
+        }
+        if (p + 2 < end && '0' == p[0] && ('x' == p[1] || 'X' == p[1]) && hexDigit(p[2]) >= 0) {
+            p += 2;
+        }
+        uint64_t value = 0;
+        for (int digit; p < end && (digit = hexDigit(*p)) >= 0; p++) {
+            value = (value << 4) | digit;
+        }
+        return negative ? (0 - value) : value;
+    }
+
+    // floating point value of field i, as atof() would parse it. A plain
+    // decimal of up to 15 digits, as the engine sends them, is exactly one
+    // division of two exact doubles; anything else goes to atof().
+    double getDouble(uint32_t i) const
+    {
+        static const double pow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+            1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+        };
+        const char *p = fieldBegin(i);
+        const char *end = fieldEnd(i);
+        while (p < end && isspace(*p)) {
+            p++;
+        }
+        bool negative = false;
+        if (p < end && ('-' == *p || '+' == *p)) {
+            negative = ('-' == *p);
+            p++;
+        }
+        uint64_t mantissa = 0;
+        uint32_t digits = 0;
+        uint32_t decimals = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            mantissa = mantissa * 10 + (*p - '0');
+        }
+        if (p < end && '.' == *p) {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++, decimals++) {
+                mantissa = mantissa * 10 + (*p - '0');
+            }
+        }
+        if (0 == digits && p == end) {
+            return 0;
+        }
+        if (digits > 0 && digits <= 15 &&
+            (p == end || ('e' != *p && 'E' != *p && 'x' != *p && 'X' != *p))) {
+            double value = (double)mantissa / pow10[decimals];
+            return negative ? -value : value;
+        }
+
+        char buf[64];
+        size_t len = end - fieldBegin(i);
+        if (len >= sizeof(buf)) {
+            len = sizeof(buf) - 1;
+        }
+        memcpy(buf, fieldBegin(i), len);
+        buf[len] = '\0';
+        return atof(buf);
+    }
+
 public:
     static const uint32_t NMEA_MINSIZE = DEBUG_NMEA_MINSIZE;
     static const uint32_t NMEA_MAXSIZE = DEBUG_NMEA_MAXSIZE;
@@ -185,35 +311,35 @@ public:
         : SystemStatusNmeaBase(str_in, len_in)
     {
         memset(&mM1, 0, sizeof(mM1));
-        if (mField.size() < eMax) {
-            LOC_LOGE("PQWM1parser - invalid size=%zu", mField.size());
+        if (mFieldCount < eMax) {
+            LOC_LOGE("PQWM1parser - invalid size=%u", mFieldCount);
             mM1.mTimeValid = 0;
             return;
         }
-        mM1.mGpsWeek = atoi(mField[eGpsWeek].c_str());
-        mM1.mGpsTowMs = atoi(mField[eGpsTowMs].c_str());
-        mM1.mTimeValid = atoi(mField[eTimeValid].c_str());
-        mM1.mTimeSource = atoi(mField[eTimeSource].c_str());
-        mM1.mTimeUnc = atoi(mField[eTimeUnc].c_str());
-        mM1.mClockFreqBias = atoi(mField[eClockFreqBias].c_str());
-        mM1.mClockFreqBiasUnc = atoi(mField[eClockFreqBiasUnc].c_str());
-        mM1.mXoState = atoi(mField[eXoState].c_str());
-        mM1.mPgaGain = atoi(mField[ePgaGain].c_str());
-        mM1.mGpsBpAmpI = atoi(mField[eGpsBpAmpI].c_str());
-        mM1.mGpsBpAmpQ = atoi(mField[eGpsBpAmpQ].c_str());
-        mM1.mAdcI = atoi(mField[eAdcI].c_str());
-        mM1.mAdcQ = atoi(mField[eAdcQ].c_str());
-        mM1.mJammerGps = atoi(mField[eJammerGps].c_str());
-        mM1.mJammerGlo = atoi(mField[eJammerGlo].c_str());
-        mM1.mJammerBds = atoi(mField[eJammerBds].c_str());
-        mM1.mJammerGal = atoi(mField[eJammerGal].c_str());
-        mM1.mRecErrorRecovery = atoi(mField[eRecErrorRecovery].c_str());
-        mM1.mAgcGps = atof(mField[eAgcGps].c_str());
-        mM1.mAgcGlo = atof(mField[eAgcGlo].c_str());
-        mM1.mAgcBds = atof(mField[eAgcBds].c_str());
-        mM1.mAgcGal = atof(mField[eAgcGal].c_str());
-        mM1.mLeapSeconds = atoi(mField[eLeapSeconds].c_str());
-        mM1.mLeapSecUnc = atoi(mField[eLeapSecUnc].c_str());
+        mM1.mGpsWeek = getInt(eGpsWeek);
+        mM1.mGpsTowMs = getInt(eGpsTowMs);
+        mM1.mTimeValid = getInt(eTimeValid);
+        mM1.mTimeSource = getInt(eTimeSource);
+        mM1.mTimeUnc = getInt(eTimeUnc);
+        mM1.mClockFreqBias = getInt(eClockFreqBias);
+        mM1.mClockFreqBiasUnc = getInt(eClockFreqBiasUnc);
+        mM1.mXoState = getInt(eXoState);
+        mM1.mPgaGain = getInt(ePgaGain);
+        mM1.mGpsBpAmpI = getInt(eGpsBpAmpI);
+        mM1.mGpsBpAmpQ = getInt(eGpsBpAmpQ);
+        mM1.mAdcI = getInt(eAdcI);
+        mM1.mAdcQ = getInt(eAdcQ);
+        mM1.mJammerGps = getInt(eJammerGps);
+        mM1.mJammerGlo = getInt(eJammerGlo);
+        mM1.mJammerBds = getInt(eJammerBds);
+        mM1.mJammerGal = getInt(eJammerGal);
+        mM1.mRecErrorRecovery = getInt(eRecErrorRecovery);
+        mM1.mAgcGps = getDouble(eAgcGps);
+        mM1.mAgcGlo = getDouble(eAgcGlo);
+        mM1.mAgcBds = getDouble(eAgcBds);
+        mM1.mAgcGal = getDouble(eAgcGal);
+        mM1.mLeapSeconds = getInt(eLeapSeconds);
+        mM1.mLeapSecUnc = getInt(eLeapSecUnc);
     }
 
     inline SystemStatusPQWM1& get() { return mM1;} //getparser
@@ -264,17 +390,17 @@ public:
     SystemStatusPQWP1parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP1, 0, sizeof(mP1));
-        mP1.mEpiValidity = strtol(mField[eEpiValidity].c_str(), NULL, 16);
-        mP1.mEpiLat = atof(mField[eEpiLat].c_str());
-        mP1.mEpiLon = atof(mField[eEpiLon].c_str());
-        mP1.mEpiAlt = atof(mField[eEpiAlt].c_str());
-        mP1.mEpiHepe = atoi(mField[eEpiHepe].c_str());
-        mP1.mEpiAltUnc = atof(mField[eEpiAltUnc].c_str());
-        mP1.mEpiSrc = atoi(mField[eEpiSrc].c_str());
+        mP1.mEpiValidity = getHex(eEpiValidity);
+        mP1.mEpiLat = getDouble(eEpiLat);
+        mP1.mEpiLon = getDouble(eEpiLon);
+        mP1.mEpiAlt = getDouble(eEpiAlt);
+        mP1.mEpiHepe = getInt(eEpiHepe);
+        mP1.mEpiAltUnc = getDouble(eEpiAltUnc);
+        mP1.mEpiSrc = getInt(eEpiSrc);
     }
 
     inline SystemStatusPQWP1& get() { return mP1;}
@@ -319,15 +445,15 @@ public:
     SystemStatusPQWP2parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP2, 0, sizeof(mP2));
-        mP2.mBestLat = atof(mField[eBestLat].c_str());
-        mP2.mBestLon = atof(mField[eBestLon].c_str());
-        mP2.mBestAlt = atof(mField[eBestAlt].c_str());
-        mP2.mBestHepe = atof(mField[eBestHepe].c_str());
-        mP2.mBestAltUnc = atof(mField[eBestAltUnc].c_str());
+        mP2.mBestLat = getDouble(eBestLat);
+        mP2.mBestLon = getDouble(eBestLon);
+        mP2.mBestAlt = getDouble(eBestAlt);
+        mP2.mBestHepe = getDouble(eBestHepe);
+        mP2.mBestAltUnc = getDouble(eBestAltUnc);
     }
 
     inline SystemStatusPQWP2& get() { return mP2;}
@@ -390,21 +516,21 @@ public:
     SystemStatusPQWP3parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP3, 0, sizeof(mP3));
-        mP3.mXtraValidMask = strtol(mField[eXtraValidMask].c_str(), NULL, 16);
-        mP3.mGpsXtraAge = atoi(mField[eGpsXtraAge].c_str());
-        mP3.mGloXtraAge = atoi(mField[eGloXtraAge].c_str());
-        mP3.mBdsXtraAge = atoi(mField[eBdsXtraAge].c_str());
-        mP3.mGalXtraAge = atoi(mField[eGalXtraAge].c_str());
-        mP3.mQzssXtraAge = atoi(mField[eQzssXtraAge].c_str());
-        mP3.mGpsXtraValid = strtol(mField[eGpsXtraValid].c_str(), NULL, 16);
-        mP3.mGloXtraValid = strtol(mField[eGloXtraValid].c_str(), NULL, 16);
-        mP3.mBdsXtraValid = strtol(mField[eBdsXtraValid].c_str(), NULL, 16);
-        mP3.mGalXtraValid = strtol(mField[eGalXtraValid].c_str(), NULL, 16);
-        mP3.mQzssXtraValid = strtol(mField[eQzssXtraValid].c_str(), NULL, 16);
+        mP3.mXtraValidMask = getHex(eXtraValidMask);
+        mP3.mGpsXtraAge = getInt(eGpsXtraAge);
+        mP3.mGloXtraAge = getInt(eGloXtraAge);
+        mP3.mBdsXtraAge = getInt(eBdsXtraAge);
+        mP3.mGalXtraAge = getInt(eGalXtraAge);
+        mP3.mQzssXtraAge = getInt(eQzssXtraAge);
+        mP3.mGpsXtraValid = getHex(eGpsXtraValid);
+        mP3.mGloXtraValid = getHex(eGloXtraValid);
+        mP3.mBdsXtraValid = getHex(eBdsXtraValid);
+        mP3.mGalXtraValid = getHex(eGalXtraValid);
+        mP3.mQzssXtraValid = getHex(eQzssXtraValid);
     }
 
     inline SystemStatusPQWP3& get() { return mP3;}
@@ -449,15 +575,15 @@ public:
     SystemStatusPQWP4parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP4, 0, sizeof(mP4));
-        mP4.mGpsEpheValid = strtol(mField[eGpsEpheValid].c_str(), NULL, 16);
-        mP4.mGloEpheValid = strtol(mField[eGloEpheValid].c_str(), NULL, 16);
-        mP4.mBdsEpheValid = strtol(mField[eBdsEpheValid].c_str(), NULL, 16);
-        mP4.mGalEpheValid = strtol(mField[eGalEpheValid].c_str(), NULL, 16);
-        mP4.mQzssEpheValid = strtol(mField[eQzssEpheValid].c_str(), NULL, 16);
+        mP4.mGpsEpheValid = getHex(eGpsEpheValid);
+        mP4.mGloEpheValid = getHex(eGloEpheValid);
+        mP4.mBdsEpheValid = getHex(eBdsEpheValid);
+        mP4.mGalEpheValid = getHex(eGalEpheValid);
+        mP4.mQzssEpheValid = getHex(eQzssEpheValid);
     }
 
     inline SystemStatusPQWP4& get() { return mP4;}
@@ -532,25 +658,25 @@ public:
     SystemStatusPQWP5parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP5, 0, sizeof(mP5));
-        mP5.mGpsUnknownMask = strtol(mField[eGpsUnknownMask].c_str(), NULL, 16);
-        mP5.mGloUnknownMask = strtol(mField[eGloUnknownMask].c_str(), NULL, 16);
-        mP5.mBdsUnknownMask = strtol(mField[eBdsUnknownMask].c_str(), NULL, 16);
-        mP5.mGalUnknownMask = strtol(mField[eGalUnknownMask].c_str(), NULL, 16);
-        mP5.mQzssUnknownMask = strtol(mField[eQzssUnknownMask].c_str(), NULL, 16);
-        mP5.mGpsGoodMask = strtol(mField[eGpsGoodMask].c_str(), NULL, 16);
-        mP5.mGloGoodMask = strtol(mField[eGloGoodMask].c_str(), NULL, 16);
-        mP5.mBdsGoodMask = strtol(mField[eBdsGoodMask].c_str(), NULL, 16);
-        mP5.mGalGoodMask = strtol(mField[eGalGoodMask].c_str(), NULL, 16);
-        mP5.mQzssGoodMask = strtol(mField[eQzssGoodMask].c_str(), NULL, 16);
-        mP5.mGpsBadMask = strtol(mField[eGpsBadMask].c_str(), NULL, 16);
-        mP5.mGloBadMask = strtol(mField[eGloBadMask].c_str(), NULL, 16);
-        mP5.mBdsBadMask = strtol(mField[eBdsBadMask].c_str(), NULL, 16);
-        mP5.mGalBadMask = strtol(mField[eGalBadMask].c_str(), NULL, 16);
-        mP5.mQzssBadMask = strtol(mField[eQzssBadMask].c_str(), NULL, 16);
+        mP5.mGpsUnknownMask = getHex(eGpsUnknownMask);
+        mP5.mGloUnknownMask = getHex(eGloUnknownMask);
+        mP5.mBdsUnknownMask = getHex(eBdsUnknownMask);
+        mP5.mGalUnknownMask = getHex(eGalUnknownMask);
+        mP5.mQzssUnknownMask = getHex(eQzssUnknownMask);
+        mP5.mGpsGoodMask = getHex(eGpsGoodMask);
+        mP5.mGloGoodMask = getHex(eGloGoodMask);
+        mP5.mBdsGoodMask = getHex(eBdsGoodMask);
+        mP5.mGalGoodMask = getHex(eGalGoodMask);
+        mP5.mQzssGoodMask = getHex(eQzssGoodMask);
+        mP5.mGpsBadMask = getHex(eGpsBadMask);
+        mP5.mGloBadMask = getHex(eGloBadMask);
+        mP5.mBdsBadMask = getHex(eBdsBadMask);
+        mP5.mGalBadMask = getHex(eGalBadMask);
+        mP5.mQzssBadMask = getHex(eQzssBadMask);
     }
 
     inline SystemStatusPQWP5& get() { return mP5;}
@@ -583,11 +709,11 @@ public:
     SystemStatusPQWP6parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP6, 0, sizeof(mP6));
-        mP6.mFixInfoMask = strtol(mField[eFixInfoMask].c_str(), NULL, 16);
+        mP6.mFixInfoMask = getHex(eFixInfoMask);
     }
 
     inline SystemStatusPQWP6& get() { return mP6;}
@@ -617,14 +743,14 @@ public:
     SystemStatusPQWP7parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
-            LOC_LOGE("PQWP7parser - invalid size=%zu", mField.size());
+        if (mFieldCount < eMax) {
+            LOC_LOGE("PQWP7parser - invalid size=%u", mFieldCount);
             return;
         }
         for (uint32_t i=0; i<SV_ALL_NUM; i++) {
-            mP7.mNav[i].mType   = GnssEphemerisType(atoi(mField[i*3+2].c_str()));
-            mP7.mNav[i].mSource = GnssEphemerisSource(atoi(mField[i*3+3].c_str()));
-            mP7.mNav[i].mAgeSec = atoi(mField[i*3+4].c_str());
+            mP7.mNav[i].mType   = GnssEphemerisType(getInt(i*3+2));
+            mP7.mNav[i].mSource = GnssEphemerisSource(getInt(i*3+3));
+            mP7.mNav[i].mAgeSec = getInt(i*3+4);
         }
     }
 
@@ -661,12 +787,12 @@ public:
     SystemStatusPQWS1parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mS1, 0, sizeof(mS1));
-        mS1.mFixInfoMask = atoi(mField[eFixInfoMask].c_str());
-        mS1.mHepeLimit = atoi(mField[eHepeLimit].c_str());
+        mS1.mFixInfoMask = getInt(eFixInfoMask);
+        mS1.mHepeLimit = getInt(eHepeLimit);
     }
 
     inline SystemStatusPQWS1& get() { return mS1;}
@@ -1216,22 +1342,60 @@ SystemStatus::SystemStatus(const MsgTask* msgTask) :
 {
     int result = 0;
     ENTRY_LOG ();
-    mCache.mLocation.clear();
 
-    mCache.mTimeAndClock.clear();
-    mCache.mXoState.clear();
-    mCache.mRfAndParams.clear();
-    mCache.mErrRecovery.clear();
+    // history depth of each report type, signed so negative values clamp to 1
+    int32_t maxLocation = SYSTEM_STATUS_HISTORY_DEFAULT;
+
+    int32_t maxTimeAndClock = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxXoState = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxRfAndParams = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxErrRecovery = SYSTEM_STATUS_HISTORY_DEFAULT;
+
+    int32_t maxInjectedPosition = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxBestPosition = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxXtra = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxEphemeris = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxSvHealth = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxPdr = SYSTEM_STATUS_HISTORY_DEFAULT;
+    int32_t maxNavData = SYSTEM_STATUS_HISTORY_DEFAULT;
+
+    int32_t maxPositionFailure = SYSTEM_STATUS_HISTORY_DEFAULT;
 
-    mCache.mInjectedPosition.clear();
-    mCache.mBestPosition.clear();
-    mCache.mXtra.clear();
-    mCache.mEphemeris.clear();
-    mCache.mSvHealth.clear();
-    mCache.mPdr.clear();
-    mCache.mNavData.clear();
+    const loc_param_s_type history_conf_param_table[] =
+    {
+        {"SYSTEM_STATUS_HISTORY_LOCATION",          &maxLocation,         NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_TIME_AND_CLOCK",    &maxTimeAndClock,     NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_XO_STATE",          &maxXoState,          NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_RF_AND_PARAMS",     &maxRfAndParams,      NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_ERR_RECOVERY",      &maxErrRecovery,      NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_INJECTED_POSITION", &maxInjectedPosition, NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_BEST_POSITION",     &maxBestPosition,     NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_XTRA",              &maxXtra,             NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_EPHEMERIS",         &maxEphemeris,        NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_SV_HEALTH",         &maxSvHealth,         NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_PDR",               &maxPdr,              NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_NAV_DATA",          &maxNavData,          NULL, 'n'},
+        {"SYSTEM_STATUS_HISTORY_POSITION_FAILURE",  &maxPositionFailure,  NULL, 'n'},
+    };
+    UTIL_READ_CONF(LOC_PATH_GPS_CONF, history_conf_param_table);
+
+    mCache.mLocation.setCapacity(maxLocation);
 
-    mCache.mPositionFailure.clear();
+    mCache.mTimeAndClock.setCapacity(maxTimeAndClock);
+    mCache.mXoState.setCapacity(maxXoState);
+    mCache.mRfAndParams.setCapacity(maxRfAndParams);
+    mCache.mErrRecovery.setCapacity(maxErrRecovery);
+
+    mCache.mInjectedPosition.setCapacity(maxInjectedPosition);
+    mCache.mBestPosition.setCapacity(maxBestPosition);
+    mCache.mXtra.setCapacity(maxXtra);
+    mCache.mEphemeris.setCapacity(maxEphemeris);
+    mCache.mSvHealth.setCapacity(maxSvHealth);
+    mCache.mPdr.setCapacity(maxPdr);
+    mCache.mNavData.setCapacity(maxNavData);
+
+    mCache.mPositionFailure.setCapacity(maxPositionFailure);
+    publishReports();
 
     EXIT_LOG_WITH_ERROR ("%d",result);
 }
@@ -1246,9 +1410,6 @@ bool SystemStatus::setTimeAndCLock(const SystemStatusPQWM1& nmea)
         mCache.mTimeAndClock.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mTimeAndClock.push_back(s);
-        if (mCache.mTimeAndClock.size() > maxTimeAndClock) {
-            mCache.mTimeAndClock.erase(mCache.mTimeAndClock.begin());
-        }
     }
     return true;
 }
@@ -1260,9 +1421,6 @@ bool SystemStatus::setXoState(const SystemStatusPQWM1& nmea)
         mCache.mXoState.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mXoState.push_back(s);
-        if (mCache.mXoState.size() > maxXoState) {
-            mCache.mXoState.erase(mCache.mXoState.begin());
-        }
     }
     return true;
 }
@@ -1274,9 +1432,6 @@ bool SystemStatus::setRfAndParams(const SystemStatusPQWM1& nmea)
         mCache.mRfAndParams.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mRfAndParams.push_back(s);
-        if (mCache.mRfAndParams.size() > maxRfAndParams) {
-            mCache.mRfAndParams.erase(mCache.mRfAndParams.begin());
-        }
     }
     return true;
 }
@@ -1288,9 +1443,6 @@ bool SystemStatus::setErrRecovery(const SystemStatusPQWM1& nmea)
         mCache.mErrRecovery.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mErrRecovery.push_back(s);
-        if (mCache.mErrRecovery.size() > maxErrRecovery) {
-            mCache.mErrRecovery.erase(mCache.mErrRecovery.begin());
-        }
     }
     return true;
 }
@@ -1305,9 +1457,6 @@ bool SystemStatus::setInjectedPosition(const SystemStatusPQWP1& nmea)
         mCache.mInjectedPosition.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mInjectedPosition.push_back(s);
-        if (mCache.mInjectedPosition.size() > maxInjectedPosition) {
-            mCache.mInjectedPosition.erase(mCache.mInjectedPosition.begin());
-        }
     }
     return true;
 }
@@ -1319,9 +1468,6 @@ bool SystemStatus::setBestPosition(const SystemStatusPQWP2& nmea)
         mCache.mBestPosition.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mBestPosition.push_back(s);
-        if (mCache.mBestPosition.size() > maxBestPosition) {
-            mCache.mBestPosition.erase(mCache.mBestPosition.begin());
-        }
     }
     return true;
 }
@@ -1333,9 +1479,6 @@ bool SystemStatus::setXtra(const SystemStatusPQWP3& nmea)
         mCache.mXtra.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mXtra.push_back(s);
-        if (mCache.mXtra.size() > maxXtra) {
-            mCache.mXtra.erase(mCache.mXtra.begin());
-        }
     }
     return true;
 }
@@ -1347,9 +1490,6 @@ bool SystemStatus::setEphemeris(const SystemStatusPQWP4& nmea)
         mCache.mEphemeris.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mEphemeris.push_back(s);
-        if (mCache.mEphemeris.size() > maxEphemeris) {
-            mCache.mEphemeris.erase(mCache.mEphemeris.begin());
-        }
     }
     return true;
 }
@@ -1361,9 +1501,6 @@ bool SystemStatus::setSvHealth(const SystemStatusPQWP5& nmea)
         mCache.mSvHealth.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mSvHealth.push_back(s);
-        if (mCache.mSvHealth.size() > maxSvHealth) {
-            mCache.mSvHealth.erase(mCache.mSvHealth.begin());
-        }
     }
     return true;
 }
@@ -1375,9 +1512,6 @@ bool SystemStatus::setPdr(const SystemStatusPQWP6& nmea)
         mCache.mPdr.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mPdr.push_back(s);
-        if (mCache.mPdr.size() > maxPdr) {
-            mCache.mPdr.erase(mCache.mPdr.begin());
-        }
     }
     return true;
 }
@@ -1389,9 +1523,6 @@ bool SystemStatus::setNavData(const SystemStatusPQWP7& nmea)
         mCache.mNavData.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mNavData.push_back(s);
-        if (mCache.mNavData.size() > maxNavData) {
-            mCache.mNavData.erase(mCache.mNavData.begin());
-        }
     }
     return true;
 }
@@ -1406,13 +1537,95 @@ bool SystemStatus::setPositionFailure(const SystemStatusPQWS1& nmea)
         mCache.mPositionFailure.back().mUtcReported = s.mUtcReported;
     } else {
         mCache.mPositionFailure.push_back(s);
-        if (mCache.mPositionFailure.size() > maxPositionFailure) {
-            mCache.mPositionFailure.erase(mCache.mPositionFailure.begin());
-        }
     }
     return true;
 }
 
+/******************************************************************************
+ SystemStatus - debug NMEA dispatch
+******************************************************************************/
+// the two characters that tell the debug sentences apart, after "$PQW"
+#define SYSTEM_STATUS_NMEA_TAG(a, b) ((uint16_t)(((uint8_t)(a) << 8) | (uint8_t)(b)))
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('M', '1')>(const char *data, uint32_t len)
+{
+    SystemStatusPQWM1 s = SystemStatusPQWM1parser(data, len).get();
+    bool ret = setTimeAndCLock(s);
+    ret |= setXoState(s);
+    ret |= setRfAndParams(s);
+    ret |= setErrRecovery(s);
+    return ret;
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '1')>(const char *data, uint32_t len)
+{
+    return setInjectedPosition(SystemStatusPQWP1parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '2')>(const char *data, uint32_t len)
+{
+    return setBestPosition(SystemStatusPQWP2parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '3')>(const char *data, uint32_t len)
+{
+    return setXtra(SystemStatusPQWP3parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '4')>(const char *data, uint32_t len)
+{
+    return setEphemeris(SystemStatusPQWP4parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '5')>(const char *data, uint32_t len)
+{
+    return setSvHealth(SystemStatusPQWP5parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '6')>(const char *data, uint32_t len)
+{
+    return setPdr(SystemStatusPQWP6parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('P', '7')>(const char *data, uint32_t len)
+{
+    return setNavData(SystemStatusPQWP7parser(data, len).get());
+}
+
+template <>
+bool SystemStatus::setNmea<SYSTEM_STATUS_NMEA_TAG('S', '1')>(const char *data, uint32_t len)
+{
+    return setPositionFailure(SystemStatusPQWS1parser(data, len).get());
+}
+
+// the debug sentences with a setNmea<TAG>(), as the tag characters and a
+// name, in the order of the setNmeaString() counters
+#define SYSTEM_STATUS_NMEA_LIST(X) \
+    X('M', '1', M1) \
+    X('P', '1', P1) \
+    X('P', '2', P2) \
+    X('P', '3', P3) \
+    X('P', '4', P4) \
+    X('P', '5', P5) \
+    X('P', '6', P6) \
+    X('P', '7', P7) \
+    X('S', '1', S1)
+
+enum SystemStatusNmeaIndex {
+#define SYSTEM_STATUS_NMEA_INDEX(a, b, name) SYSTEM_STATUS_NMEA_##name,
+    SYSTEM_STATUS_NMEA_LIST(SYSTEM_STATUS_NMEA_INDEX)
+#undef SYSTEM_STATUS_NMEA_INDEX
+    SYSTEM_STATUS_NMEA_MAX
+};
+
 /******************************************************************************
 @brief      API to set report data into internal buffer
 
@@ -1422,84 +1635,60 @@ bool SystemStatus::setPositionFailure(const SystemStatusPQWS1& nmea)
 @return     true when successfully done
 ******************************************************************************/
 static uint32_t cnt = 0;
-static uint32_t cnt_m1 = 0;
-static uint32_t cnt_p1 = 0;
-static uint32_t cnt_p2 = 0;
-static uint32_t cnt_p3 = 0;
-static uint32_t cnt_p4 = 0;
-static uint32_t cnt_p5 = 0;
-static uint32_t cnt_p6 = 0;
-static uint32_t cnt_p7 = 0;
-static uint32_t cnt_s1 = 0;
+static uint32_t cnt_tag[SYSTEM_STATUS_NMEA_MAX] = { 0 };
 
 bool SystemStatus::setNmeaString(const char *data, uint32_t len)
 {
-    bool ret = false;
-    if (!loc_nmea_is_debug(data, len)) {
+    // "$PQW", all the debug sentences start with it, as one integer
+    static const uint32_t debugTalker =
+            ((uint32_t)'$' << 24) | ((uint32_t)'P' << 16) | ((uint32_t)'Q' << 8) | 'W';
+
+    if ((nullptr == data) ||
+        (len < SystemStatusNmeaBase::NMEA_MINSIZE) || (len > SystemStatusNmeaBase::NMEA_MAXSIZE)) {
+        return false;
+    }
+    uint32_t talker = ((uint32_t)(uint8_t)data[0] << 24) | ((uint32_t)(uint8_t)data[1] << 16) |
+                      ((uint32_t)(uint8_t)data[2] << 8) | (uint32_t)(uint8_t)data[3];
+    if (talker != debugTalker) {
         return false;
     }
-
-    char buf[SystemStatusNmeaBase::NMEA_MAXSIZE + 1] = { 0 };
-    strlcpy(buf, data, sizeof(buf));
 
     pthread_mutex_lock(&mMutexSystemStatus);
 
     // parse the received nmea strings here
-    if      (0 == strncmp(data, "$PQWM1", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        SystemStatusPQWM1 s = SystemStatusPQWM1parser(buf, len).get();
-        ret  = setTimeAndCLock(s);
-        ret |= setXoState(s);
-        ret |= setRfAndParams(s);
-        ret |= setErrRecovery(s);
-        cnt_m1++;
-    }
-    else if (0 == strncmp(data, "$PQWP1", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setInjectedPosition(SystemStatusPQWP1parser(buf, len).get());
-        cnt_p1++;
-    }
-    else if (0 == strncmp(data, "$PQWP2", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setBestPosition(SystemStatusPQWP2parser(buf, len).get());
-        cnt_p2++;
-    }
-    else if (0 == strncmp(data, "$PQWP3", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setXtra(SystemStatusPQWP3parser(buf, len).get());
-        cnt_p3++;
-    }
-    else if (0 == strncmp(data, "$PQWP4", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setEphemeris(SystemStatusPQWP4parser(buf, len).get());
-        cnt_p4++;
-    }
-    else if (0 == strncmp(data, "$PQWP5", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setSvHealth(SystemStatusPQWP5parser(buf, len).get());
-        cnt_p5++;
-    }
-    else if (0 == strncmp(data, "$PQWP6", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setPdr(SystemStatusPQWP6parser(buf, len).get());
-        cnt_p6++;
-    }
-    else if (0 == strncmp(data, "$PQWP7", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setNavData(SystemStatusPQWP7parser(buf, len).get());
-        cnt_p7++;
-    }
-    else if (0 == strncmp(data, "$PQWS1", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        ret = setPositionFailure(SystemStatusPQWS1parser(buf, len).get());
-        cnt_s1++;
-    }
-    else {
-        // do nothing
+    bool ret = false;
+    uint32_t index = SYSTEM_STATUS_NMEA_MAX;
+    switch (SYSTEM_STATUS_NMEA_TAG(data[4], data[5])) {
+#define SYSTEM_STATUS_NMEA_CASE(a, b, name)                                  \
+    case SYSTEM_STATUS_NMEA_TAG(a, b):                                       \
+        ret = setNmea<SYSTEM_STATUS_NMEA_TAG(a, b)>(data, len);              \
+        index = SYSTEM_STATUS_NMEA_##name;                                   \
+        break;
+    SYSTEM_STATUS_NMEA_LIST(SYSTEM_STATUS_NMEA_CASE)
+#undef SYSTEM_STATUS_NMEA_CASE
+    default:
+        break;
+    }
+
+    if (index < SYSTEM_STATUS_NMEA_MAX) {
+        cnt_tag[index]++;
+        cnt++;
+        LOC_LOGV("setNmeaString: cnt=%d M:%d 1:%d 2:%d 3:%d 4:%d 5:%d 6:%d 7:%d S:%d",
+                 cnt,
+                 cnt_tag[SYSTEM_STATUS_NMEA_M1],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P1],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P2],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P3],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P4],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P5],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P6],
+                 cnt_tag[SYSTEM_STATUS_NMEA_P7],
+                 cnt_tag[SYSTEM_STATUS_NMEA_S1]);
+    }
+
+    if (ret) {
+        publishReports();
     }
-    cnt++;
-    LOC_LOGV("setNmeaString: cnt=%d M:%d 1:%d 2:%d 3:%d 4:%d 5:%d 6:%d 7:%d S:%d",
-             cnt,
-             cnt_m1,
-             cnt_p1,
-             cnt_p2,
-             cnt_p3,
-             cnt_p4,
-             cnt_p5,
-             cnt_p6,
-             cnt_p7,
-             cnt_s1);
 
     pthread_mutex_unlock(&mMutexSystemStatus);
     return ret;
@@ -1516,15 +1705,17 @@ bool SystemStatus::eventPosition(const UlpLocation& location,
                                  const GpsLocationExtended& locationEx)
 {
     SystemStatusLocation s(location, locationEx);
+
+    pthread_mutex_lock(&mMutexSystemStatus);
     if (!mCache.mLocation.empty() && mCache.mLocation.back().equals(s)) {
         mCache.mLocation.back().mUtcReported = s.mUtcReported;
     }
     else {
         mCache.mLocation.push_back(s);
-        if (mCache.mLocation.size() > maxLocation) {
-            mCache.mLocation.erase(mCache.mLocation.begin());
-        }
     }
+    publishReports();
+    pthread_mutex_unlock(&mMutexSystemStatus);
+
     LOC_LOGV("eventPosition - lat=%f lon=%f alt=%f speed=%f",
              s.mLocation.gpsLocation.latitude,
              s.mLocation.gpsLocation.longitude,
@@ -1533,6 +1724,53 @@ bool SystemStatus::eventPosition(const UlpLocation& location,
     return true;
 }
 
+/******************************************************************************
+@brief      API to get the latest published reports, without waiting for the
+            writers. The snapshot only holds the latest report of each type,
+            never changes, and is valid for as long as it is referenced.
+
+@param[In]  none
+
+@return     the reports
+******************************************************************************/
+std::shared_ptr<const SystemStatusReports> SystemStatus::getReportSnapshot() const
+{
+    return std::atomic_load(&mSnapshot);
+}
+
+/******************************************************************************
+@brief      publish the latest report of each type to the readers, called
+            with mMutexSystemStatus held after the internal buffer has been
+            updated
+
+@param[In]  none
+
+@return     none
+******************************************************************************/
+void SystemStatus::publishReports()
+{
+    std::shared_ptr<SystemStatusReports> latest = std::make_shared<SystemStatusReports>(1);
+
+    latest->mLocation.assignLatest(mCache.mLocation);
+
+    latest->mTimeAndClock.assignLatest(mCache.mTimeAndClock);
+    latest->mXoState.assignLatest(mCache.mXoState);
+    latest->mRfAndParams.assignLatest(mCache.mRfAndParams);
+    latest->mErrRecovery.assignLatest(mCache.mErrRecovery);
+
+    latest->mInjectedPosition.assignLatest(mCache.mInjectedPosition);
+    latest->mBestPosition.assignLatest(mCache.mBestPosition);
+    latest->mXtra.assignLatest(mCache.mXtra);
+    latest->mEphemeris.assignLatest(mCache.mEphemeris);
+    latest->mSvHealth.assignLatest(mCache.mSvHealth);
+    latest->mPdr.assignLatest(mCache.mPdr);
+    latest->mNavData.assignLatest(mCache.mNavData);
+
+    latest->mPositionFailure.assignLatest(mCache.mPositionFailure);
+
+    std::atomic_store(&mSnapshot, std::shared_ptr<const SystemStatusReports>(latest));
+}
+
 /******************************************************************************
 @brief      API to get report data into a given buffer
 
@@ -1543,77 +1781,104 @@ bool SystemStatus::eventPosition(const UlpLocation& location,
 ******************************************************************************/
 bool SystemStatus::getReport(SystemStatusReports& report, bool isLatestOnly) const
 {
-    pthread_mutex_lock(&mMutexSystemStatus);
-
     if (isLatestOnly) {
+        std::shared_ptr<const SystemStatusReports> snapshot = getReportSnapshot();
+        const SystemStatusReports& cache = *snapshot;
+
         // push back only the latest report and return it
         report.mLocation.clear();
-        if (mCache.mLocation.size() >= 1) {
-            report.mLocation.push_back(mCache.mLocation.back());
-            report.mLocation.back().dump();
+        if (cache.mLocation.size() >= 1) {
+            report.mLocation.push_back(cache.mLocation.back());
+            IF_LOC_LOGV {
+                report.mLocation.back().dump();
+            }
         }
 
         report.mTimeAndClock.clear();
-        if (mCache.mTimeAndClock.size() >= 1) {
-            report.mTimeAndClock.push_back(mCache.mTimeAndClock.back());
-            report.mTimeAndClock.back().dump();
+        if (cache.mTimeAndClock.size() >= 1) {
+            report.mTimeAndClock.push_back(cache.mTimeAndClock.back());
+            IF_LOC_LOGV {
+                report.mTimeAndClock.back().dump();
+            }
         }
         report.mXoState.clear();
-        if (mCache.mXoState.size() >= 1) {
-            report.mXoState.push_back(mCache.mXoState.back());
-            report.mXoState.back().dump();
+        if (cache.mXoState.size() >= 1) {
+            report.mXoState.push_back(cache.mXoState.back());
+            IF_LOC_LOGV {
+                report.mXoState.back().dump();
+            }
         }
         report.mRfAndParams.clear();
-        if (mCache.mRfAndParams.size() >= 1) {
-            report.mRfAndParams.push_back(mCache.mRfAndParams.back());
-            report.mRfAndParams.back().dump();
+        if (cache.mRfAndParams.size() >= 1) {
+            report.mRfAndParams.push_back(cache.mRfAndParams.back());
+            IF_LOC_LOGV {
+                report.mRfAndParams.back().dump();
+            }
         }
         report.mErrRecovery.clear();
-        if (mCache.mErrRecovery.size() >= 1) {
-            report.mErrRecovery.push_back(mCache.mErrRecovery.back());
-            report.mErrRecovery.back().dump();
+        if (cache.mErrRecovery.size() >= 1) {
+            report.mErrRecovery.push_back(cache.mErrRecovery.back());
+            IF_LOC_LOGV {
+                report.mErrRecovery.back().dump();
+            }
         }
 
         report.mInjectedPosition.clear();
-        if (mCache.mInjectedPosition.size() >= 1) {
-            report.mInjectedPosition.push_back(mCache.mInjectedPosition.back());
-            report.mInjectedPosition.back().dump();
+        if (cache.mInjectedPosition.size() >= 1) {
+            report.mInjectedPosition.push_back(cache.mInjectedPosition.back());
+            IF_LOC_LOGV {
+                report.mInjectedPosition.back().dump();
+            }
         }
         report.mBestPosition.clear();
-        if (mCache.mBestPosition.size() >= 1) {
-            report.mBestPosition.push_back(mCache.mBestPosition.back());
-            report.mBestPosition.back().dump();
+        if (cache.mBestPosition.size() >= 1) {
+            report.mBestPosition.push_back(cache.mBestPosition.back());
+            IF_LOC_LOGV {
+                report.mBestPosition.back().dump();
+            }
         }
         report.mXtra.clear();
-        if (mCache.mXtra.size() >= 1) {
-            report.mXtra.push_back(mCache.mXtra.back());
-            report.mXtra.back().dump();
+        if (cache.mXtra.size() >= 1) {
+            report.mXtra.push_back(cache.mXtra.back());
+            IF_LOC_LOGV {
+                report.mXtra.back().dump();
+            }
         }
         report.mEphemeris.clear();
-        if (mCache.mEphemeris.size() >= 1) {
-            report.mEphemeris.push_back(mCache.mEphemeris.back());
-            report.mEphemeris.back().dump();
+        if (cache.mEphemeris.size() >= 1) {
+            report.mEphemeris.push_back(cache.mEphemeris.back());
+            IF_LOC_LOGV {
+                report.mEphemeris.back().dump();
+            }
         }
         report.mSvHealth.clear();
-        if (mCache.mSvHealth.size() >= 1) {
-            report.mSvHealth.push_back(mCache.mSvHealth.back());
-            report.mSvHealth.back().dump();
+        if (cache.mSvHealth.size() >= 1) {
+            report.mSvHealth.push_back(cache.mSvHealth.back());
+            IF_LOC_LOGV {
+                report.mSvHealth.back().dump();
+            }
         }
         report.mPdr.clear();
-        if (mCache.mPdr.size() >= 1) {
-            report.mPdr.push_back(mCache.mPdr.back());
-            report.mPdr.back().dump();
+        if (cache.mPdr.size() >= 1) {
+            report.mPdr.push_back(cache.mPdr.back());
+            IF_LOC_LOGV {
+                report.mPdr.back().dump();
+            }
         }
         report.mNavData.clear();
-        if (mCache.mNavData.size() >= 1) {
-            report.mNavData.push_back(mCache.mNavData.back());
-            report.mNavData.back().dump();
+        if (cache.mNavData.size() >= 1) {
+            report.mNavData.push_back(cache.mNavData.back());
+            IF_LOC_LOGV {
+                report.mNavData.back().dump();
+            }
         }
 
         report.mPositionFailure.clear();
-        if (mCache.mPositionFailure.size() >= 1) {
-            report.mPositionFailure.push_back(mCache.mPositionFailure.back());
-            report.mPositionFailure.back().dump();
+        if (cache.mPositionFailure.size() >= 1) {
+            report.mPositionFailure.push_back(cache.mPositionFailure.back());
+            IF_LOC_LOGV {
+                report.mPositionFailure.back().dump();
+            }
         }
     }
     else {
@@ -1634,10 +1899,13 @@ bool SystemStatus::getReport(SystemStatusReports& report, bool isLatestOnly) con
         report.mNavData.clear();
 
         report.mPositionFailure.clear();
+
+        // only the latest reports are published, the history is in mCache
+        pthread_mutex_lock(&mMutexSystemStatus);
         report = mCache;
+        pthread_mutex_unlock(&mMutexSystemStatus);
     }
 
-    pthread_mutex_unlock(&mMutexSystemStatus);
     return true;
 }
 
@@ -1653,61 +1921,23 @@ bool SystemStatus::setDefaultReport(void)
     pthread_mutex_lock(&mMutexSystemStatus);
 
     mCache.mLocation.push_back(SystemStatusLocation());
-    if (mCache.mLocation.size() > maxLocation) {
-        mCache.mLocation.erase(mCache.mLocation.begin());
-    }
 
     mCache.mTimeAndClock.push_back(SystemStatusTimeAndClock());
-    if (mCache.mTimeAndClock.size() > maxTimeAndClock) {
-        mCache.mTimeAndClock.erase(mCache.mTimeAndClock.begin());
-    }
     mCache.mXoState.push_back(SystemStatusXoState());
-    if (mCache.mXoState.size() > maxXoState) {
-        mCache.mXoState.erase(mCache.mXoState.begin());
-    }
     mCache.mRfAndParams.push_back(SystemStatusRfAndParams());
-    if (mCache.mRfAndParams.size() > maxRfAndParams) {
-        mCache.mRfAndParams.erase(mCache.mRfAndParams.begin());
-    }
     mCache.mErrRecovery.push_back(SystemStatusErrRecovery());
-    if (mCache.mErrRecovery.size() > maxErrRecovery) {
-        mCache.mErrRecovery.erase(mCache.mErrRecovery.begin());
-    }
 
     mCache.mInjectedPosition.push_back(SystemStatusInjectedPosition());
-    if (mCache.mInjectedPosition.size() > maxInjectedPosition) {
-        mCache.mInjectedPosition.erase(mCache.mInjectedPosition.begin());
-    }
     mCache.mBestPosition.push_back(SystemStatusBestPosition());
-    if (mCache.mBestPosition.size() > maxBestPosition) {
-        mCache.mBestPosition.erase(mCache.mBestPosition.begin());
-    }
     mCache.mXtra.push_back(SystemStatusXtra());
-    if (mCache.mXtra.size() > maxXtra) {
-        mCache.mXtra.erase(mCache.mXtra.begin());
-    }
     mCache.mEphemeris.push_back(SystemStatusEphemeris());
-    if (mCache.mEphemeris.size() > maxEphemeris) {
-        mCache.mEphemeris.erase(mCache.mEphemeris.begin());
-    }
     mCache.mSvHealth.push_back(SystemStatusSvHealth());
-    if (mCache.mSvHealth.size() > maxSvHealth) {
-        mCache.mSvHealth.erase(mCache.mSvHealth.begin());
-    }
     mCache.mPdr.push_back(SystemStatusPdr());
-    if (mCache.mPdr.size() > maxPdr) {
-        mCache.mPdr.erase(mCache.mPdr.begin());
-    }
     mCache.mNavData.push_back(SystemStatusNavData());
-    if (mCache.mNavData.size() > maxNavData) {
-        mCache.mNavData.erase(mCache.mNavData.begin());
-    }
 
     mCache.mPositionFailure.push_back(SystemStatusPositionFailure());
-    if (mCache.mPositionFailure.size() > maxPositionFailure) {
-        mCache.mPositionFailure.erase(mCache.mPositionFailure.begin());
-    }
 
+    publishReports();
     pthread_mutex_unlock(&mMutexSystemStatus);
     return true;
 }
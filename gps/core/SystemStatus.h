@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include <memory>
 #include <platform_lib_log_util.h>
 #include <MsgTask.h>
 #include <IOsObserver.h>
@@ -54,6 +55,10 @@
 #define GAL_NUM  (36)
 #define SV_ALL_NUM  (GPS_NUM+GLO_NUM+QZSS_NUM+BDS_NUM+GAL_NUM) //=134
 
+// history depth of each report type, unless set in gps.conf
+#define SYSTEM_STATUS_HISTORY_DEFAULT (5)
+#define SYSTEM_STATUS_HISTORY_MAX     (100)
+
 namespace loc_core
 {
 
@@ -367,28 +372,100 @@ public:
     void dump(void);
 };
 
+/******************************************************************************
+ SystemStatusHistory
+******************************************************************************/
+// Fixed capacity ring of the latest reports of one type, oldest first.
+// The storage is allocated when the capacity is set, after which pushing
+// a report overwrites the oldest one once full, instead of shifting all
+// of them down.
+template <typename T>
+class SystemStatusHistory
+{
+    std::vector<T> mItems;
+    uint32_t mCapacity;
+    uint32_t mHead;  // index in mItems of the oldest report
+    uint32_t mSize;
+
+    inline uint32_t indexOf(uint32_t i) const {
+        uint32_t index = mHead + i;
+        return (index >= mCapacity) ? (index - mCapacity) : index;
+    }
+public:
+    inline SystemStatusHistory(int32_t capacity = SYSTEM_STATUS_HISTORY_DEFAULT) :
+        mItems(), mCapacity(0), mHead(0), mSize(0) {
+        setCapacity(capacity);
+    }
+    // drops all the reports; capacity is clamped to [1, MAX]
+    inline void setCapacity(int32_t capacity) {
+        if (capacity < 1) {
+            capacity = 1;
+        } else if (capacity > SYSTEM_STATUS_HISTORY_MAX) {
+            capacity = SYSTEM_STATUS_HISTORY_MAX;
+        }
+        mItems.assign(capacity, T());
+        mCapacity = capacity;
+        clear();
+    }
+    inline uint32_t capacity() const { return mCapacity; }
+    inline uint32_t size() const { return mSize; }
+    inline bool empty() const { return 0 == mSize; }
+    inline void clear() { mHead = 0; mSize = 0; }
+    // i-th report, 0 being the oldest one
+    inline T& operator[](uint32_t i) { return mItems[indexOf(i)]; }
+    inline const T& operator[](uint32_t i) const { return mItems[indexOf(i)]; }
+    inline T& front() { return mItems[mHead]; }
+    inline const T& front() const { return mItems[mHead]; }
+    inline T& back() { return mItems[indexOf(mSize - 1)]; }
+    inline const T& back() const { return mItems[indexOf(mSize - 1)]; }
+    inline void push_back(const T& item) {
+        if (mSize < mCapacity) {
+            mItems[indexOf(mSize)] = item;
+            mSize++;
+        } else {
+            mItems[mHead] = item;
+            mHead = indexOf(1);
+        }
+    }
+    // keeps only the latest report of another history, if it has any
+    inline void assignLatest(const SystemStatusHistory<T>& other) {
+        clear();
+        if (!other.empty()) {
+            push_back(other.back());
+        }
+    }
+};
+
 /******************************************************************************
  SystemStatusReports
 ******************************************************************************/
 class SystemStatusReports
 {
 public:
-    std::vector<SystemStatusLocation>         mLocation;
-
-    std::vector<SystemStatusTimeAndClock>     mTimeAndClock;
-    std::vector<SystemStatusXoState>          mXoState;
-    std::vector<SystemStatusRfAndParams>      mRfAndParams;
-    std::vector<SystemStatusErrRecovery>      mErrRecovery;
-
-    std::vector<SystemStatusInjectedPosition> mInjectedPosition;
-    std::vector<SystemStatusBestPosition>     mBestPosition;
-    std::vector<SystemStatusXtra>             mXtra;
-    std::vector<SystemStatusEphemeris>        mEphemeris;
-    std::vector<SystemStatusSvHealth>         mSvHealth;
-    std::vector<SystemStatusPdr>              mPdr;
-    std::vector<SystemStatusNavData>          mNavData;
-
-    std::vector<SystemStatusPositionFailure>  mPositionFailure;
+    inline explicit SystemStatusReports(int32_t capacity = SYSTEM_STATUS_HISTORY_DEFAULT) :
+        mLocation(capacity),
+        mTimeAndClock(capacity), mXoState(capacity), mRfAndParams(capacity),
+        mErrRecovery(capacity),
+        mInjectedPosition(capacity), mBestPosition(capacity), mXtra(capacity),
+        mEphemeris(capacity), mSvHealth(capacity), mPdr(capacity), mNavData(capacity),
+        mPositionFailure(capacity) {}
+
+    SystemStatusHistory<SystemStatusLocation>         mLocation;
+
+    SystemStatusHistory<SystemStatusTimeAndClock>     mTimeAndClock;
+    SystemStatusHistory<SystemStatusXoState>          mXoState;
+    SystemStatusHistory<SystemStatusRfAndParams>      mRfAndParams;
+    SystemStatusHistory<SystemStatusErrRecovery>      mErrRecovery;
+
+    SystemStatusHistory<SystemStatusInjectedPosition> mInjectedPosition;
+    SystemStatusHistory<SystemStatusBestPosition>     mBestPosition;
+    SystemStatusHistory<SystemStatusXtra>             mXtra;
+    SystemStatusHistory<SystemStatusEphemeris>        mEphemeris;
+    SystemStatusHistory<SystemStatusSvHealth>         mSvHealth;
+    SystemStatusHistory<SystemStatusPdr>              mPdr;
+    SystemStatusHistory<SystemStatusNavData>          mNavData;
+
+    SystemStatusHistory<SystemStatusPositionFailure>  mPositionFailure;
 };
 
 /******************************************************************************
@@ -407,24 +484,12 @@ private:
     // Data members
     static pthread_mutex_t                    mMutexSystemStatus;
 
-    static const uint32_t                     maxLocation = 5;
-
-    static const uint32_t                     maxTimeAndClock = 5;
-    static const uint32_t                     maxXoState = 5;
-    static const uint32_t                     maxRfAndParams = 5;
-    static const uint32_t                     maxErrRecovery = 5;
-
-    static const uint32_t                     maxInjectedPosition = 5;
-    static const uint32_t                     maxBestPosition = 5;
-    static const uint32_t                     maxXtra = 5;
-    static const uint32_t                     maxEphemeris = 5;
-    static const uint32_t                     maxSvHealth = 5;
-    static const uint32_t                     maxPdr = 5;
-    static const uint32_t                     maxNavData = 5;
-
-    static const uint32_t                     maxPositionFailure = 5;
-
+    // written under mMutexSystemStatus. Each writer then publishes the
+    // latest report of each type to the readers as a new immutable
+    // mSnapshot, only accessed with std::atomic_load and std::atomic_store
     SystemStatusReports mCache;
+    std::shared_ptr<const SystemStatusReports> mSnapshot;
+    void publishReports();
 
     bool setLocation(const UlpLocation& location);
 
@@ -443,6 +508,9 @@ private:
 
     bool setPositionFailure(const SystemStatusPQWS1& nmea);
 
+    // parses a debug NMEA sentence by its tag, see setNmeaString
+    template <uint16_t TAG> bool setNmea(const char *data, uint32_t len);
+
 public:
     // Static methods
     static SystemStatus* getInstance(const MsgTask* msgTask);
@@ -453,6 +521,7 @@ public:
     bool eventPosition(const UlpLocation& location,const GpsLocationExtended& locationEx);
     bool setNmeaString(const char *data, uint32_t len);
     bool getReport(SystemStatusReports& reports, bool isLatestonly = false) const;
+    std::shared_ptr<const SystemStatusReports> getReportSnapshot() const;
     bool setDefaultReport(void);
 };
 
@@ -49,16 +49,22 @@
 #include <DataItemsFactoryProxy.h>
 
 #include <platform_lib_log_util.h>
+#include <loc_cfg.h>
 
 namespace loc_core
 {
 #define BREAK_IF_ZERO(ERR,X) if(0==(X)) {result = (ERR); break;}
 #define BREAK_IF_NON_ZERO(ERR,X) if(0!=(X)) {result = (ERR); break;}
 
+#define OS_OBSERVER_NOTIFY_WINDOW_MAX_MS (1000)
+
 SystemStatusOsObserver::SystemStatusOsObserver(const MsgTask* msgTask) :
     mAddress ("SystemStatusOsObserver"),
     mClientIndex(IndexFactory <IDataItemObserver *, DataItemId> :: createClientIndex ()),
-    mDataItemIndex(IndexFactory <IDataItemObserver *, DataItemId> :: createDataItemIndex ())
+    mDataItemIndex(IndexFactory <IDataItemObserver *, DataItemId> :: createDataItemIndex ()),
+    mNotifyWindowMs (0),
+    mNotifyWindowOpen (false),
+    mNotifyWindowTimer (this)
 {
     int result = -1;
     ENTRY_LOG ();
@@ -66,6 +72,16 @@ SystemStatusOsObserver::SystemStatusOsObserver(const MsgTask* msgTask) :
         BREAK_IF_ZERO (1, mClientIndex);
         BREAK_IF_ZERO (2, mDataItemIndex);
         mContext.mMsgTask = msgTask;
+
+        const loc_param_s_type notify_conf_param_table[] =
+        {
+            {"OS_OBSERVER_NOTIFY_WINDOW_MS", &mNotifyWindowMs, NULL, 'n'}
+        };
+        UTIL_READ_CONF(LOC_PATH_GPS_CONF, notify_conf_param_table);
+        if (mNotifyWindowMs > OS_OBSERVER_NOTIFY_WINDOW_MAX_MS) {
+            mNotifyWindowMs = OS_OBSERVER_NOTIFY_WINDOW_MAX_MS;
+        }
+        LOC_LOGD ("%s: notify window %u ms", __func__, mNotifyWindowMs);
         result = 0;
     } while (0);
     EXIT_LOG_WITH_ERROR ("%d",result);
@@ -73,6 +89,8 @@ SystemStatusOsObserver::SystemStatusOsObserver(const MsgTask* msgTask) :
 
 SystemStatusOsObserver :: ~SystemStatusOsObserver ()
 {
+    mNotifyWindowTimer.stop ();
+
     // Close data-item library handle
     DataItemsFactoryProxy::closeDataItemLibraryHandle();
 
@@ -280,23 +298,6 @@ void SystemStatusOsObserver :: HandleUnsubscribeAllReq :: proc () const {
     EXIT_LOG_WITH_ERROR ("%d",result);
 }
 
-void SystemStatusOsObserver :: HandleNotify :: getListOfClients
- (const list <DataItemId> & dlist, list <IDataItemObserver *> & clients ) const {
-
-     list <DataItemId> :: const_iterator it = dlist.begin ();
-     for (; it != dlist.end (); ++it) {
-         list <IDataItemObserver *> clientList;
-         this->mParent->mDataItemIndex->getListOfSubscribedClients ( (*it), clientList);
-         list <IDataItemObserver *> :: iterator citer = clientList.begin ();
-         for (; citer != clientList.end (); ++citer) {
-             clients.push_back (*citer);
-         }
-         clientList.clear ();
-     }
-     // remove duplicates
-     clients.unique ();
-}
-
 void SystemStatusOsObserver :: HandleNotify :: proc () const {
     int result = 0;
     ENTRY_LOG ();
@@ -304,7 +305,7 @@ void SystemStatusOsObserver :: HandleNotify :: proc () const {
         // Update Cache with received data items and prepare
         // list of data items to be sent.
         list <IDataItemCore *> :: const_iterator it = mDList.begin ();
-        list <DataItemId> dataItemIdsToBeSent;
+        vector <DataItemId> & dataItemIdsToBeSent = this->mParent->mPendingNotifyIds;
         for (; it != mDList.end (); ++it) {
             bool dataItemUpdated = false;
             this->mParent->updateCache (*it, dataItemUpdated);
@@ -312,34 +313,39 @@ void SystemStatusOsObserver :: HandleNotify :: proc () const {
                 dataItemIdsToBeSent.push_back ( (*it)->getId ());
             }
         }
+        if (dataItemIdsToBeSent.empty ()) {
+            break;
+        }
 
-        list <IDataItemObserver *> clientList;
-        this->getListOfClients (dataItemIdsToBeSent, clientList);
-        list <IDataItemObserver *> :: iterator citer = clientList.begin ();
-        // Send data item to all subscribed clients
-        LOC_LOGD ("LocTech-Label :: SystemStatusOsObserver :: Data Items Out");
-        for (; citer != clientList.end (); ++citer) {
-            do {
-                list <DataItemId> dataItemIdsSubscribedByThisClient;
-                list <DataItemId> dataItemIdsToBeSentForThisClient;
-                this->mParent->mClientIndex->getSubscribedList (*citer, dataItemIdsSubscribedByThisClient);
-                dataItemIdsSubscribedByThisClient.sort ();
-                dataItemIdsToBeSent.sort ();
-                set_intersection (dataItemIdsToBeSent.begin (),
-                                 dataItemIdsToBeSent.end (),
-                                 dataItemIdsSubscribedByThisClient.begin (),
-                                 dataItemIdsSubscribedByThisClient.end (),
-                                 inserter (dataItemIdsToBeSentForThisClient,
-                                         dataItemIdsToBeSentForThisClient.begin ()));
-                BREAK_IF_NON_ZERO (4,this->mParent->sendCachedDataItems (dataItemIdsToBeSentForThisClient, *citer));
-                dataItemIdsSubscribedByThisClient.clear ();
-                dataItemIdsToBeSentForThisClient.clear ();
-            } while (0);
+        if (0 == this->mParent->mNotifyWindowMs) {
+            this->mParent->sendUpdatedDataItems (dataItemIdsToBeSent);
+        } else if (!this->mParent->mNotifyWindowOpen) {
+            // the updates are held back until the window closes, any update
+            // of the same data items within it only refreshes the cache
+            this->mParent->mNotifyWindowOpen =
+                this->mParent->mNotifyWindowTimer.start (this->mParent->mNotifyWindowMs, false,
+                                                         this->mParent->mNotifyWindowMs / 4);
+            if (!this->mParent->mNotifyWindowOpen) {
+                this->mParent->sendUpdatedDataItems (dataItemIdsToBeSent);
+            }
         }
     } while (0);
     EXIT_LOG_WITH_ERROR ("%d", result);
 }
 
+void SystemStatusOsObserver :: NotifyWindowTimer :: timeOutCallback () {
+    // expires on the timer thread, the pending ids belong to the msg task
+    mParent->mContext.mMsgTask->sendMsg (new (nothrow) HandleNotifyWindowExpiry (mParent));
+}
+
+void SystemStatusOsObserver :: HandleNotifyWindowExpiry :: proc () const {
+    int result = 0;
+    ENTRY_LOG ();
+    this->mParent->mNotifyWindowOpen = false;
+    this->mParent->sendUpdatedDataItems (this->mParent->mPendingNotifyIds);
+    EXIT_LOG_WITH_ERROR ("%d", result);
+}
+
 void SystemStatusOsObserver :: HandleTurnOn :: proc () const {
     int result = 0;
     ENTRY_LOG ();
@@ -453,7 +459,6 @@ void SystemStatusOsObserver::notify(const std::list <IDataItemCore *> & dlist) {
     do {
         list <IDataItemCore *> :: const_iterator it = dlist.begin ();
         list <IDataItemCore *> dataItemList;
-        list <DataItemId> ids;
         LOC_LOGD("LocTech-Label :: SystemStatusOsObserver :: Data Items In");
         for (; it != dlist.end (); ++it) {
             if (*it != NULL) {
@@ -465,7 +470,6 @@ void SystemStatusOsObserver::notify(const std::list <IDataItemCore *> & dlist) {
                 // Copy contents into the newly created data item
                 dataitem->copy(*it);
                 dataItemList.push_back(dataitem);
-                ids.push_back((*it)->getId());
             }
         }
         mContext.mMsgTask->sendMsg(new (nothrow) HandleNotify (this, dataItemList));
@@ -587,6 +591,46 @@ int SystemStatusOsObserver :: sendFirstResponse (const list <DataItemId> & l, ID
     return result;
 }
 
+// Sends the cached values of the updated data items to every client
+// subscribed to any of them, one notify per client, and clears ids.
+void SystemStatusOsObserver :: sendUpdatedDataItems (vector <DataItemId> & ids) {
+    int result = 0;
+    ENTRY_LOG ();
+    sort (ids.begin (), ids.end ());
+    ids.erase (unique (ids.begin (), ids.end ()), ids.end ());
+
+    vector <IDataItemObserver *> clientList;
+    vector <DataItemId> :: const_iterator it = ids.begin ();
+    for (; it != ids.end (); ++it) {
+        const vector <IDataItemObserver *> & clients =
+            mDataItemIndex->getSubscribedClients (*it);
+        vector <IDataItemObserver *> :: const_iterator citer = clients.begin ();
+        for (; citer != clients.end (); ++citer) {
+            // skip duplicates, a client may subscribe to several of the items
+            if (find (clientList.begin (), clientList.end (), *citer) == clientList.end ()) {
+                clientList.push_back (*citer);
+            }
+        }
+    }
+
+    // Send data item to all subscribed clients
+    LOC_LOGD ("LocTech-Label :: SystemStatusOsObserver :: Data Items Out");
+    vector <IDataItemObserver *> :: iterator citer = clientList.begin ();
+    for (; citer != clientList.end (); ++citer) {
+        do {
+            list <DataItemId> dataItemIdsToBeSentForThisClient;
+            for (it = ids.begin (); it != ids.end (); ++it) {
+                if (mClientIndex->isSubscribed (*citer, *it)) {
+                    dataItemIdsToBeSentForThisClient.push_back (*it);
+                }
+            }
+            BREAK_IF_NON_ZERO (4, sendCachedDataItems (dataItemIdsToBeSentForThisClient, *citer));
+        } while (0);
+    }
+    ids.clear ();
+    EXIT_LOG_WITH_ERROR ("%d", result);
+}
+
 int SystemStatusOsObserver :: sendCachedDataItems (const list <DataItemId> & l, IDataItemObserver * to) {
     int result = 0;
     ENTRY_LOG ();
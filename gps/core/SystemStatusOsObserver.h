@@ -38,6 +38,7 @@
 #include <platform_lib_log_util.h>
 #include <DataItemId.h>
 #include <MsgTask.h>
+#include <LocTimer.h>
 #include <IOsObserver.h>
 
 namespace loc_core
@@ -121,6 +122,23 @@ private:
     map < DataItemId, IDataItemCore * >                  mDataItemCache;
     map < DataItemId, int >                              mActiveRequestCount;
 
+    // Optional notification coalescing window, OS_OBSERVER_NOTIFY_WINDOW_MS
+    // in gps.conf. Within the window updated data item ids are collected,
+    // the cache always holds the latest value, and each client gets one
+    // notify for all of them when the window closes. 0 disables it.
+    class NotifyWindowTimer : public LocTimer {
+    public:
+        inline NotifyWindowTimer (SystemStatusOsObserver * parent) :
+            LocTimer (), mParent (parent) {}
+        virtual void timeOutCallback ();
+    private:
+        SystemStatusOsObserver * mParent;
+    };
+    uint32_t                                             mNotifyWindowMs;
+    bool                                                 mNotifyWindowOpen;
+    vector <DataItemId>                                  mPendingNotifyIds;
+    NotifyWindowTimer                                    mNotifyWindowTimer;
+
     // Nested types
     // Messages
     struct HandleMsgBase : public LocMsg {
@@ -144,6 +162,7 @@ private:
     );
 
     int updateCache (IDataItemCore * d, bool &dataItemUpdated);
+    void sendUpdatedDataItems (vector <DataItemId> & ids);
     void logMe (const list <DataItemId> & l);
 
     // Messages
@@ -205,18 +224,20 @@ private:
     };
 
     struct HandleNotify : public HandleMsgBase {
-        HandleNotify (SystemStatusOsObserver * parent, list <IDataItemCore *> dlist);
+        // takes over the data items in dlist, leaving it empty
+        HandleNotify (SystemStatusOsObserver * parent, list <IDataItemCore *> & dlist);
         virtual ~HandleNotify ();
-        void getListOfClients
-        (
-            const list <DataItemId> & dlist,
-            list <IDataItemObserver *> & clients
-        ) const;
         void proc () const;
         // Data members
         list <IDataItemCore *> mDList;
     };
 
+    struct HandleNotifyWindowExpiry : public HandleMsgBase {
+        HandleNotifyWindowExpiry (SystemStatusOsObserver * parent);
+        virtual ~HandleNotifyWindowExpiry ();
+        void proc () const;
+    };
+
     struct HandleTurnOn : public HandleMsgBase  {
         HandleTurnOn (SystemStatusOsObserver * parent,
                           const DataItemId dit,
@@ -289,9 +310,17 @@ HandleClientMsg (parent, client)
 {}
 
 inline SystemStatusOsObserver :: HandleNotify :: HandleNotify
- (SystemStatusOsObserver * parent, list <IDataItemCore *> dlist)
+ (SystemStatusOsObserver * parent, list <IDataItemCore *> & dlist)
+:
+HandleMsgBase (parent)
+{
+    mDList.swap (dlist);
+}
+
+inline SystemStatusOsObserver :: HandleNotifyWindowExpiry :: HandleNotifyWindowExpiry
+ (SystemStatusOsObserver * parent)
 :
-HandleMsgBase (parent), mDList (dlist)
+HandleMsgBase (parent)
 {}
 
 inline SystemStatusOsObserver :: HandleTurnOn :: HandleTurnOn
@@ -323,6 +352,7 @@ inline SystemStatusOsObserver :: HandleNotify :: ~HandleNotify () {
     }
 }
 
+inline SystemStatusOsObserver :: HandleNotifyWindowExpiry :: ~HandleNotifyWindowExpiry () {}
 inline SystemStatusOsObserver :: HandleTurnOn :: ~HandleTurnOn () {}
 inline SystemStatusOsObserver :: HandleTurnOff :: ~HandleTurnOff () {}
 
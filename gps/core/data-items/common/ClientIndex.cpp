@@ -27,7 +27,6 @@
  *
  */
 #include <algorithm>
-#include <iterator>
 #include <string>
 #include <platform_lib_log_util.h>
 #include <ClientIndex.h>
@@ -43,26 +42,64 @@ inline ClientIndex <CT,DIT> :: ClientIndex () {}
 template <typename CT, typename DIT>
 inline ClientIndex <CT,DIT> :: ~ClientIndex () {}
 
+template <typename CT, typename DIT>
+typename vector < pair < CT, bitset <MAX_DATA_ITEM_ID> > > :: iterator
+ClientIndex <CT,DIT> :: find (CT client) {
+    typename vector <ClientEntry> :: iterator it = mDataItemsPerClient.begin ();
+    for (; it != mDataItemsPerClient.end (); ++it) {
+        if (it->first == client) {
+            break;
+        }
+    }
+    return it;
+}
+
+template <typename CT, typename DIT>
+bitset <MAX_DATA_ITEM_ID> ClientIndex <CT,DIT> :: toSet (const list <DIT> & l) {
+    DataItemSet s;
+    typename list <DIT> :: const_iterator it = l.begin ();
+    for (; it != l.end (); ++it) {
+        if (*it >= 0 && *it < MAX_DATA_ITEM_ID) {
+            s.set (*it);
+        }
+    }
+    return s;
+}
+
+template <typename CT, typename DIT>
+void ClientIndex <CT,DIT> :: toList (const DataItemSet & s, list <DIT> & out) {
+    for (int i = 0; i < MAX_DATA_ITEM_ID; i++) {
+        if (s.test (i)) {
+            out.push_back ((DIT)i);
+        }
+    }
+}
+
 template <typename CT, typename DIT>
 bool ClientIndex <CT,DIT> :: isSubscribedClient (CT client) {
     bool result = false;
     ENTRY_LOG ();
-    typename map < CT, list <DIT> > :: iterator it =
-        mDataItemsPerClientMap.find (client);
-    if (it != mDataItemsPerClientMap.end ()) {
+    if (find (client) != mDataItemsPerClient.end ()) {
         result = true;
     }
     EXIT_LOG_WITH_ERROR ("%d",result);
     return result;
 }
 
+template <typename CT, typename DIT>
+bool ClientIndex <CT,DIT> :: isSubscribed (CT client, DIT id) {
+    typename vector <ClientEntry> :: iterator it = find (client);
+    return (it != mDataItemsPerClient.end () &&
+            id >= 0 && id < MAX_DATA_ITEM_ID && it->second.test (id));
+}
+
 template <typename CT, typename DIT>
 void ClientIndex <CT,DIT> :: getSubscribedList (CT client, list <DIT> & out) {
     ENTRY_LOG ();
-    typename map < CT, list <DIT> > :: iterator it =
-        mDataItemsPerClientMap.find (client);
-    if (it != mDataItemsPerClientMap.end ()) {
-        out = it->second;
+    typename vector <ClientEntry> :: iterator it = find (client);
+    if (it != mDataItemsPerClient.end ()) {
+        out.clear ();
+        toList (it->second, out);
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
 }
@@ -71,7 +108,10 @@ template <typename CT, typename DIT>
 int ClientIndex <CT,DIT> :: remove (CT client) {
     int result = 0;
     ENTRY_LOG ();
-    mDataItemsPerClientMap.erase (client);
+    typename vector <ClientEntry> :: iterator it = find (client);
+    if (it != mDataItemsPerClient.end ()) {
+        mDataItemsPerClient.erase (it);
+    }
     EXIT_LOG_WITH_ERROR ("%d",result);
     return result;
 }
@@ -79,22 +119,14 @@ int ClientIndex <CT,DIT> :: remove (CT client) {
 template <typename CT, typename DIT>
 void ClientIndex <CT,DIT> :: remove (const list <DIT> & r, list <CT> & out) {
     ENTRY_LOG ();
-    typename map < CT, list <DIT> > :: iterator dicIter =
-        mDataItemsPerClientMap.begin ();
-    while (dicIter != mDataItemsPerClientMap.end()) {
-        typename list <DIT> :: const_iterator it = r.begin ();
-        for (; it != r.end (); ++it) {
-            typename list <DIT> :: iterator iter =
-                find (dicIter->second.begin (), dicIter->second.end (), *it);
-            if (iter != dicIter->second.end ()) {
-                dicIter->second.erase (iter);
-            }
-        }
-        if (dicIter->second.empty ()) {
+    DataItemSet removed = toSet (r);
+    typename vector <ClientEntry> :: iterator dicIter =
+        mDataItemsPerClient.begin ();
+    while (dicIter != mDataItemsPerClient.end()) {
+        dicIter->second &= ~removed;
+        if (dicIter->second.none ()) {
             out.push_back (dicIter->first);
-            // Post-increment operator increases the iterator but returns the
-            // prevous one that will be invalidated by erase()
-            mDataItemsPerClientMap.erase (dicIter++);
+            dicIter = mDataItemsPerClient.erase (dicIter);
         } else {
             ++dicIter;
         }
@@ -111,23 +143,13 @@ void ClientIndex <CT,DIT> :: remove
 )
 {
     ENTRY_LOG ();
-    typename map < CT, list <DIT> > :: iterator dicIter =
-        mDataItemsPerClientMap.find (client);
-    if (dicIter != mDataItemsPerClientMap.end ()) {
-        set_intersection (dicIter->second.begin (), dicIter->second.end (),
-                         r.begin (), r.end (),
-                         inserter (out,out.begin ()));
-        if (!out.empty ()) {
-            typename list <DIT> :: iterator it = out.begin ();
-            for (; it != out.end (); ++it) {
-                dicIter->second.erase (find (dicIter->second.begin (),
-                                            dicIter->second.end (),
-                                            *it));
-            }
-        }
-        if (dicIter->second.empty ()) {
-            mDataItemsPerClientMap.erase (dicIter);
-            EXIT_LOG_WITH_ERROR ("%d",0);
+    typename vector <ClientEntry> :: iterator dicIter = find (client);
+    if (dicIter != mDataItemsPerClient.end ()) {
+        DataItemSet removed = dicIter->second & toSet (r);
+        toList (removed, out);
+        dicIter->second &= ~removed;
+        if (dicIter->second.none ()) {
+            mDataItemsPerClient.erase (dicIter);
         }
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
@@ -142,23 +164,17 @@ void ClientIndex <CT,DIT> :: add
 )
 {
     ENTRY_LOG ();
-    list <DIT> difference;
-    typename map < CT, list <DIT> > :: iterator dicIter =
-        mDataItemsPerClientMap.find (client);
-    if (dicIter != mDataItemsPerClientMap.end ()) {
-        set_difference (l.begin (), l.end (),
-                       dicIter->second.begin (), dicIter->second.end (),
-                       inserter (difference,difference.begin ()));
-        if (!difference.empty ()) {
-            difference.sort ();
-            out = difference;
-            dicIter->second.merge (difference);
-            dicIter->second.unique ();
+    typename vector <ClientEntry> :: iterator dicIter = find (client);
+    if (dicIter != mDataItemsPerClient.end ()) {
+        DataItemSet difference = toSet (l) & ~dicIter->second;
+        if (difference.any ()) {
+            out.clear ();
+            toList (difference, out);
+            dicIter->second |= difference;
         }
     } else {
         out = l;
-        pair < CT, list <DIT> > dicnpair (client, out);
-        mDataItemsPerClientMap.insert (dicnpair);
+        mDataItemsPerClient.push_back (ClientEntry (client, toSet (l)));
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
 }
@@ -30,8 +30,10 @@
 #define __CLIENTINDEX_H__
 
 #include <list>
-#include <map>
+#include <vector>
+#include <bitset>
 #include <IClientIndex.h>
+#include <DataItemId.h>
 
 using loc_core::IClientIndex;
 
@@ -60,9 +62,22 @@ public:
 
     void add (CT client, const std :: list <DIT> & l, std :: list <DIT> & out);
 
+    bool isSubscribed (CT client, DIT id);
+
 private:
+    // One bit per data item id; a client's subscription is a single word
+    // instead of a list node per data item.
+    typedef std :: bitset <MAX_DATA_ITEM_ID> DataItemSet;
+    typedef std :: pair <CT, DataItemSet> ClientEntry;
+
+    typename std :: vector <ClientEntry> :: iterator find (CT client);
+    static DataItemSet toSet (const std :: list <DIT> & l);
+    static void toList (const DataItemSet & s, std :: list <DIT> & out);
+
     //Data members
-    std :: map < CT , std :: list <DIT> > mDataItemsPerClientMap;
+    // There are only a handful of clients, a linear scan of a contiguous
+    // vector beats a map lookup and a node allocation per client.
+    std :: vector <ClientEntry> mDataItemsPerClient;
 };
 
 } // namespace loc_core
@@ -29,7 +29,6 @@
 
 #include <string>
 #include <algorithm>
-#include <iterator>
 #include <DataItemIndex.h>
 #include <platform_lib_log_util.h>
 #include <IDataItemObserver.h>
@@ -51,19 +50,27 @@ void DataItemIndex <CT,DIT> :: getListOfSubscribedClients
     list <CT> & out
 )
 {
-    typename map < DIT, list <CT> > :: iterator cdiIter =
-        mClientsPerDataItemMap.find (id);
-    if (cdiIter != mClientsPerDataItemMap.end ()) {
-        out = cdiIter->second;
+    const vector <CT> & clients = getSubscribedClients (id);
+    if (!clients.empty ()) {
+        out.assign (clients.begin (), clients.end ());
     }
 }
 
+template <typename CT, typename DIT>
+const vector <CT> & DataItemIndex <CT,DIT> :: getSubscribedClients (DIT id) {
+    if (id < 0 || id >= MAX_DATA_ITEM_ID) {
+        return mNoClients;
+    }
+    return mClientsPerDataItem [id];
+}
 
 template <typename CT, typename DIT>
 int DataItemIndex <CT,DIT> :: remove (DIT id) {
     int result = 0;
     ENTRY_LOG ();
-    mClientsPerDataItemMap.erase (id);
+    if (id >= 0 && id < MAX_DATA_ITEM_ID) {
+        mClientsPerDataItem [id].clear ();
+    }
     EXIT_LOG_WITH_ERROR ("%d",result);
     return result;
 }
@@ -71,30 +78,21 @@ int DataItemIndex <CT,DIT> :: remove (DIT id) {
 template <typename CT, typename DIT>
 void DataItemIndex <CT,DIT> :: remove (const list <CT> & r, list <DIT> & out) {
     ENTRY_LOG ();
-    typename map < DIT, list <CT> > :: iterator cdiIter =
-        mClientsPerDataItemMap.begin ();
-    while (cdiIter != mClientsPerDataItemMap.end()) {
+    for (int i = 0; i < MAX_DATA_ITEM_ID; i++) {
+        vector <CT> & clients = mClientsPerDataItem [i];
+        if (clients.empty ()) {
+            continue;
+        }
         typename list <CT> :: const_iterator it = r.begin ();
         for (; it != r.end (); ++it) {
-            typename list <CT> :: iterator iter =
-                find
-                (
-                    cdiIter->second.begin (),
-                    cdiIter->second.end (),
-                    *it
-                );
-            if (iter != cdiIter->second.end ()) {
-                cdiIter->second.erase (iter);
+            typename vector <CT> :: iterator iter =
+                find (clients.begin (), clients.end (), *it);
+            if (iter != clients.end ()) {
+                clients.erase (iter);
             }
         }
-
-        if (cdiIter->second.empty ()) {
-            out.push_back (cdiIter->first);
-            // Post-increment operator increases the iterator but returns the
-            // prevous one that will be invalidated by erase()
-            mClientsPerDataItemMap.erase (cdiIter++);
-        } else {
-            ++cdiIter;
+        if (clients.empty ()) {
+            out.push_back ((DIT)i);
         }
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
@@ -109,25 +107,17 @@ void DataItemIndex <CT,DIT> :: remove
 )
 {
     ENTRY_LOG ();
-
-    typename map < DIT, list <CT> > :: iterator cdiIter =
-        mClientsPerDataItemMap.find (id);
-    if (cdiIter != mClientsPerDataItemMap.end ()) {
-        set_intersection (cdiIter->second.begin (), cdiIter->second.end (),
-                         r.begin (), r.end (),
-                         inserter (out, out.begin ()));
-        if (!out.empty ()) {
-            typename list <CT> :: iterator it = out.begin ();
-            for (; it != out.end (); ++it) {
-                cdiIter->second.erase (find (cdiIter->second.begin (),
-                                            cdiIter->second.end (),
-                                            *it));
+    if (id >= 0 && id < MAX_DATA_ITEM_ID) {
+        vector <CT> & clients = mClientsPerDataItem [id];
+        typename list <CT> :: const_iterator it = r.begin ();
+        for (; it != r.end (); ++it) {
+            typename vector <CT> :: iterator iter =
+                find (clients.begin (), clients.end (), *it);
+            if (iter != clients.end ()) {
+                out.push_back (*iter);
+                clients.erase (iter);
             }
         }
-        if (cdiIter->second.empty ()) {
-            mClientsPerDataItemMap.erase (cdiIter);
-            EXIT_LOG_WITH_ERROR ("%d",0);
-        }
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
 }
@@ -141,22 +131,21 @@ void DataItemIndex <CT,DIT> :: add
 )
 {
     ENTRY_LOG ();
-    list <CT> difference;
-    typename map < DIT, list <CT> > :: iterator cdiIter =
-        mClientsPerDataItemMap.find (id);
-    if (cdiIter != mClientsPerDataItemMap.end ()) {
-        set_difference (l.begin (), l.end (),
-                       cdiIter->second.begin (), cdiIter->second.end (),
-                       inserter (difference, difference.begin ()));
-        if (!difference.empty ()) {
-            difference.sort ();
-            out = difference;
-            cdiIter->second.merge (difference);
+    if (id >= 0 && id < MAX_DATA_ITEM_ID) {
+        vector <CT> & clients = mClientsPerDataItem [id];
+        bool newEntry = clients.empty ();
+        if (newEntry) {
+            out = l;
+        }
+        typename list <CT> :: const_iterator it = l.begin ();
+        for (; it != l.end (); ++it) {
+            if (find (clients.begin (), clients.end (), *it) == clients.end ()) {
+                if (!newEntry) {
+                    out.push_back (*it);
+                }
+                clients.push_back (*it);
+            }
         }
-    } else {
-        out = l;
-        pair < DIT, list <CT> > cndipair (id, out);
-        mClientsPerDataItemMap.insert (cndipair);
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
 }
@@ -170,25 +159,17 @@ void DataItemIndex <CT,DIT> :: add
 )
 {
     ENTRY_LOG ();
-    typename map < DIT, list <CT> > :: iterator cdiIter;
     typename list <DIT> :: const_iterator it = l.begin ();
     for (; it != l.end (); ++it) {
-        cdiIter = mClientsPerDataItemMap.find (*it);
-        if (cdiIter == mClientsPerDataItemMap.end ()) {
+        if (*it < 0 || *it >= MAX_DATA_ITEM_ID) {
+            continue;
+        }
+        vector <CT> & clients = mClientsPerDataItem [*it];
+        if (clients.empty ()) {
             out.push_back (*it);
-            pair < DIT, list <CT> > cndiPair (*it, list <CT> (1, client));
-            mClientsPerDataItemMap.insert (cndiPair);
-        } else {
-          typename list<CT> :: iterator clientIter =
-              find
-              (
-                cdiIter->second.begin (),
-                cdiIter->second.end (),
-                client
-              );
-            if (clientIter == cdiIter->second.end()) {
-              cdiIter->second.push_back (client);
-            }
+            clients.push_back (client);
+        } else if (find (clients.begin (), clients.end (), client) == clients.end ()) {
+            clients.push_back (client);
         }
     }
     EXIT_LOG_WITH_ERROR ("%d",0);
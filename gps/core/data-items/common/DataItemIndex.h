@@ -31,8 +31,9 @@
 #define __DATAITEMINDEX_H__
 
 #include <list>
-#include <map>
+#include <vector>
 #include <IDataItemIndex.h>
+#include <DataItemId.h>
 
 using loc_core::IDataItemIndex;
 
@@ -51,6 +52,8 @@ public:
 
     void getListOfSubscribedClients (DIT id, std :: list <CT> & out);
 
+    const std :: vector <CT> & getSubscribedClients (DIT id);
+
     int remove (DIT id);
 
     void remove (const std :: list <CT> & r, std :: list <DIT> & out);
@@ -62,7 +65,10 @@ public:
     void add (CT client, const std :: list <DIT> & l, std :: list <DIT> & out);
 
 private:
-    std :: map < DIT, std :: list <CT> > mClientsPerDataItemMap;
+    // Data item ids are small and dense, so the clients of each are kept in
+    // a vector indexed directly by id; an empty vector means no entry.
+    std :: vector <CT> mClientsPerDataItem [MAX_DATA_ITEM_ID];
+    std :: vector <CT> mNoClients;
 };
 
 } // namespace loc_core
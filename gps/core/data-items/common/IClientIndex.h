@@ -74,6 +74,9 @@ public:
         std :: list <DIT> & out
     ) = 0;
 
+    // Checks if client is subscribed to the data item
+    virtual bool isSubscribed (CT client, DIT id) = 0;
+
     // dtor
     virtual ~IClientIndex () {}
 };
@@ -31,6 +31,7 @@
 #define __IDATAITEMINDEX_H__
 
 #include <list>
+#include <vector>
 
 namespace loc_core
 {
@@ -48,6 +49,10 @@ public:
         std :: list <CT> & out
     ) = 0;
 
+    // gets subscribed clients without copying them, valid until the
+    // next modification of the index
+    virtual const std :: vector <CT> & getSubscribedClients (DIT id) = 0;
+
     // removes an entry from
     virtual int remove (DIT id) = 0;
 
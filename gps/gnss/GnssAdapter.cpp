@@ -55,7 +55,9 @@ GnssAdapter::GnssAdapter() :
                    LocDualContext::getLocFgContext(NULL,
                                                    NULL,
                                                    LocDualContext::mLocationHalName,
-                                                   false)),
+                                                   false),
+                   NULL,
+                   GNSS_ADAPTER_FORWARDED_MASK),
     mUlpProxy(new UlpProxyBase()),
     mUlpPositionMode(),
     mGnssSvIdUsedInPosition(),
@@ -63,9 +65,11 @@ GnssAdapter::GnssAdapter() :
     mControlCallbacks(),
     mPowerVoteId(0),
     mNmeaMask(0),
+    mNmeaContext(),
     mNiData(),
     mAgpsManager(),
     mAgpsCbInfo(),
+    mXtraObserver(mMsgTask),
     mSystemStatus(SystemStatus::getInstance(mMsgTask))
 {
     LOC_LOGD("%s]: Constructor %p", __func__, this);
@@ -880,6 +884,30 @@ GnssAdapter::injectLocationCommand(double latitude, double longitude, float accu
     sendMsg(new MsgInjectLocation(*mLocApi, *mContext, latitude, longitude, accuracy));
 }
 
+void
+GnssAdapter::updateConnectionStatusCommand(bool connected, uint8_t type)
+{
+    LOC_LOGD("%s]: connected %d type %u", __func__, connected, type);
+
+    struct MsgUpdateConnectionStatus : public LocMsg {
+        XtraSystemStatusObserver& mXtraObserver;
+        bool mConnected;
+        uint8_t mType;
+        inline MsgUpdateConnectionStatus(XtraSystemStatusObserver& xtraObserver,
+                                         bool connected,
+                                         uint8_t type) :
+            LocMsg(),
+            mXtraObserver(xtraObserver),
+            mConnected(connected),
+            mType(type) {}
+        inline virtual void proc() const {
+            mXtraObserver.updateConnectionStatus(mConnected, mType);
+        }
+    };
+
+    sendMsg(new MsgUpdateConnectionStatus(mXtraObserver, connected, type));
+}
+
 void
 GnssAdapter::injectTimeCommand(int64_t time, int64_t timeReference, int32_t uncertainty)
 {
@@ -1017,12 +1045,14 @@ GnssAdapter::stopClientSessions(LocationAPI* client)
         if (client == it->first.client) {
             LocationError err = stopTrackingMultiplex(it->first.client, it->first.id);
             if (LOCATION_ERROR_SUCCESS == err) {
+                mTrackingIntervals.erase(std::make_pair(it->second.minInterval, it->first));
                 it = mTrackingSessions.erase(it);
                 continue;
             }
         }
         ++it; // increment only when not erasing an iterator
     }
+    updateTrackingClient(client);
 
 }
 
@@ -1089,16 +1119,13 @@ GnssAdapter::restartSessions()
     }
 
     // get the LocationOptions that has the smallest interval, which should be the active one
-    LocationOptions smallestIntervalOptions = {}; // size is zero until set for the first time
-    for (auto it = mTrackingSessions.begin(); it != mTrackingSessions.end(); ++it) {
-        if (0 == smallestIntervalOptions.size || //size of zero means we havent set it yet
-            it->second.minInterval < smallestIntervalOptions.minInterval) {
-             smallestIntervalOptions = it->second;
-        }
+    const LocationOptions* smallestIntervalOptions = getSmallestIntervalOptions(NULL);
+    if (NULL == smallestIntervalOptions) {
+        return;
     }
 
     LocPosMode locPosMode = {};
-    convertOptions(locPosMode, smallestIntervalOptions);
+    convertOptions(locPosMode, *smallestIntervalOptions);
     mLocApi->startFix(locPosMode);
 }
 
@@ -1191,6 +1218,7 @@ void
 GnssAdapter::saveClient(LocationAPI* client, const LocationCallbacks& callbacks)
 {
     mClientData[client] = callbacks;
+    updateClientCallbacks();
     updateClientsEventMask();
 }
 
@@ -1201,9 +1229,49 @@ GnssAdapter::eraseClient(LocationAPI* client)
     if (it != mClientData.end()) {
         mClientData.erase(it);
     }
+    updateClientCallbacks();
     updateClientsEventMask();
 }
 
+void
+GnssAdapter::updateClientCallbacks()
+{
+    // the clients still registered keep their last reported fix
+    std::vector<TrackingClient> trackingClients;
+    trackingClients.swap(mTrackingClients);
+    mGnssLocationInfoCbs.clear();
+    mGnssSvCbs.clear();
+    mGnssNmeaCbs.clear();
+    mGnssMeasurementsCbs.clear();
+    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
+        if (nullptr != it->second.trackingCb) {
+            TrackingClient trackingClient = {};
+            for (auto old = trackingClients.begin(); old != trackingClients.end(); ++old) {
+                if (it->first == old->client) {
+                    trackingClient = *old;
+                    break;
+                }
+            }
+            trackingClient.client = it->first;
+            trackingClient.trackingCb = it->second.trackingCb;
+            mTrackingClients.push_back(trackingClient);
+            updateTrackingClient(it->first);
+        }
+        if (nullptr != it->second.gnssLocationInfoCb) {
+            mGnssLocationInfoCbs.push_back(it->second.gnssLocationInfoCb);
+        }
+        if (nullptr != it->second.gnssSvCb) {
+            mGnssSvCbs.push_back(it->second.gnssSvCb);
+        }
+        if (nullptr != it->second.gnssNmeaCb) {
+            mGnssNmeaCbs.push_back(it->second.gnssNmeaCb);
+        }
+        if (nullptr != it->second.gnssMeasurementsCb) {
+            mGnssMeasurementsCbs.push_back(it->second.gnssMeasurementsCb);
+        }
+    }
+}
+
 bool
 GnssAdapter::hasTrackingCallback(LocationAPI* client)
 {
@@ -1230,7 +1298,13 @@ GnssAdapter::saveTrackingSession(LocationAPI* client, uint32_t sessionId,
                                  const LocationOptions& options)
 {
     LocationSessionKey key(client, sessionId);
+    auto it = mTrackingSessions.find(key);
+    if (it != mTrackingSessions.end()) {
+        mTrackingIntervals.erase(std::make_pair(it->second.minInterval, key));
+    }
     mTrackingSessions[key] = options;
+    mTrackingIntervals.insert(std::make_pair(options.minInterval, key));
+    updateTrackingClient(client, true);
 }
 
 void
@@ -1239,9 +1313,87 @@ GnssAdapter::eraseTrackingSession(LocationAPI* client, uint32_t sessionId)
     LocationSessionKey key(client, sessionId);
     auto it = mTrackingSessions.find(key);
     if (it != mTrackingSessions.end()) {
+        mTrackingIntervals.erase(std::make_pair(it->second.minInterval, key));
         mTrackingSessions.erase(it);
     }
+    updateTrackingClient(client);
+}
+
+void
+GnssAdapter::updateTrackingClient(LocationAPI* client, bool sessionStarted)
+{
+    for (auto it = mTrackingClients.begin(); it != mTrackingClients.end(); ++it) {
+        if (client == it->client) {
+            // a started or updated session gets its first fix right away
+            if (sessionStarted) {
+                it->reported = false;
+            }
+            // a client without tracking sessions of its own gets every fix
+            bool found = false;
+            it->minInterval = 0;
+            it->minDistance = 0;
+            for (auto session = mTrackingSessions.begin();
+                 session != mTrackingSessions.end(); ++session) {
+                if (client == session->first.client) {
+                    if (!found || session->second.minInterval < it->minInterval) {
+                        it->minInterval = session->second.minInterval;
+                    }
+                    if (!found || session->second.minDistance < it->minDistance) {
+                        it->minDistance = session->second.minDistance;
+                    }
+                    found = true;
+                }
+            }
+            break;
+        }
+    }
+}
+
+bool
+GnssAdapter::isTrackingReportDue(const TrackingClient& trackingClient,
+                                 const Location& location, uint32_t tolerance)
+{
+    if (!trackingClient.reported || location.timestamp < trackingClient.lastTimestamp) {
+        return true;
+    }
+    if (location.timestamp - trackingClient.lastTimestamp + tolerance <
+        trackingClient.minInterval) {
+        return false;
+    }
+    if (trackingClient.minDistance > 0) {
+        // equirectangular approximation, good enough at these distances
+        const double earthRadius = 6371000.0;
+        double lat1 = trackingClient.lastLatitude * M_PI / 180.0;
+        double lat2 = location.latitude * M_PI / 180.0;
+        double dLon = (location.longitude - trackingClient.lastLongitude) * M_PI / 180.0;
+        if (dLon > M_PI) {
+            dLon -= 2 * M_PI;
+        } else if (dLon < -M_PI) {
+            dLon += 2 * M_PI;
+        }
+        double x = dLon * cos((lat1 + lat2) / 2);
+        double y = lat2 - lat1;
+        if (sqrt(x * x + y * y) * earthRadius < trackingClient.minDistance) {
+            return false;
+        }
+    }
+    return true;
+}
 
+const LocationOptions*
+GnssAdapter::getSmallestIntervalOptions(const LocationSessionKey* excluded)
+{
+    // each session is in mTrackingIntervals once, so the smallest interval is
+    // the first entry, or the second one when the first is the excluded key
+    auto it = mTrackingIntervals.begin();
+    if (it != mTrackingIntervals.end() && NULL != excluded && it->second == *excluded) {
+        ++it;
+    }
+    if (it == mTrackingIntervals.end()) {
+        return NULL;
+    }
+    auto session = mTrackingSessions.find(it->second);
+    return (session != mTrackingSessions.end()) ? &session->second : NULL;
 }
 
 void
@@ -1352,15 +1504,10 @@ GnssAdapter::startTrackingMultiplex(const LocationOptions& options)
         err = startTracking(options);
     } else {
         // get the LocationOptions that has the smallest interval, which should be the active one
-        LocationOptions smallestIntervalOptions = {}; // size is zero until set for the first time
-        for (auto it = mTrackingSessions.begin(); it != mTrackingSessions.end(); ++it) {
-            if (0 == smallestIntervalOptions.size || //size of zero means we havent set it yet
-                it->second.minInterval < smallestIntervalOptions.minInterval) {
-                 smallestIntervalOptions = it->second;
-            }
-        }
+        const LocationOptions* smallestIntervalOptions = getSmallestIntervalOptions(NULL);
         // if new session's minInterval is smaller than any in other sessions
-        if (options.minInterval < smallestIntervalOptions.minInterval) {
+        if (NULL != smallestIntervalOptions &&
+            options.minInterval < smallestIntervalOptions->minInterval) {
             // restart time based tracking with new options
             err = startTracking(options);
         }
@@ -1503,23 +1650,17 @@ GnssAdapter::updateTrackingMultiplex(LocationAPI* client, uint32_t id,
         auto it = mTrackingSessions.find(key);
         if (it != mTrackingSessions.end()) {
             // find the smallest interval, other than the session we are updating
-            LocationOptions smallestIntervalOptions = {}; // size is 0 until set for the first time
-            for (auto it2 = mTrackingSessions.begin(); it2 != mTrackingSessions.end(); ++it2) {
-                // if session is not the one we are updating and either smallest interval is not set
-                // or there is a new smallest interval, then set the new smallest interval
-                if (it2->first != key && (0 == smallestIntervalOptions.size ||
-                    it2->second.minInterval < smallestIntervalOptions.minInterval)) {
-                     smallestIntervalOptions = it2->second;
-                }
-            }
+            const LocationOptions* smallestIntervalOptions = getSmallestIntervalOptions(&key);
+            if (NULL == smallestIntervalOptions) {
+                // no other session, nothing to compare against
             // if session we are updating has smaller interval then next smallest
-            if (options.minInterval < smallestIntervalOptions.minInterval) {
+            } else if (options.minInterval < smallestIntervalOptions->minInterval) {
                 // restart time based tracking with the newly updated interval
                 err = startTracking(options);
             // else if the session we are updating used to be the smallest
-            } else if (it->second.minInterval < smallestIntervalOptions.minInterval) {
+            } else if (it->second.minInterval < smallestIntervalOptions->minInterval) {
                 // restart time based tracking with the next smallest
-                err = startTracking(smallestIntervalOptions);
+                err = startTracking(*smallestIntervalOptions);
             }
         }
     }
@@ -1580,19 +1721,12 @@ GnssAdapter::stopTrackingMultiplex(LocationAPI* client, uint32_t id)
         auto it = mTrackingSessions.find(key);
         if (it != mTrackingSessions.end()) {
             // find the next smallest interval, other than the session we are stopping
-            LocationOptions smallestIntervalOptions = {}; // size is 0 until set for the first time
-            for (auto it2 = mTrackingSessions.begin(); it2 != mTrackingSessions.end(); ++it2) {
-                // if session is not the one we are stopping and either smallest interval is not set
-                // or there is a new smallest interval, then set the new smallest interval
-                if (it2->first != key && (0 == smallestIntervalOptions.size ||
-                    it2->second.minInterval < smallestIntervalOptions.minInterval)) {
-                     smallestIntervalOptions = it2->second;
-                }
-            }
+            const LocationOptions* smallestIntervalOptions = getSmallestIntervalOptions(&key);
             // if session we are stopping has smaller interval then next smallest
-            if (it->second.minInterval < smallestIntervalOptions.minInterval) {
+            if (NULL != smallestIntervalOptions &&
+                it->second.minInterval < smallestIntervalOptions->minInterval) {
                 // restart time based tracking with next smallest interval
-                err = startTracking(smallestIntervalOptions);
+                err = startTracking(*smallestIntervalOptions);
             }
         }
     }
@@ -1718,11 +1852,7 @@ GnssAdapter::gnssNiResponseCommand(LocationAPI* client,
                     // ignore any SUPL NI non-Es session if a SUPL NI ES is accepted
                     if (mResponse == GNSS_NI_RESPONSE_ACCEPT &&
                         NULL != niData.session.rawRequest) {
-                            pthread_mutex_lock(&niData.session.tLock);
-                            niData.session.resp = GNSS_NI_RESPONSE_IGNORE;
-                            niData.session.respRecvd = true;
-                            pthread_cond_signal(&niData.session.tCond);
-                            pthread_mutex_unlock(&niData.session.tLock);
+                            mAdapter.endNiSession(niData.session, GNSS_NI_RESPONSE_IGNORE);
                     }
                 } else if (mSessionId == niData.session.reqID &&
                     NULL != niData.session.rawRequest) {
@@ -1732,11 +1862,7 @@ GnssAdapter::gnssNiResponseCommand(LocationAPI* client,
                 if (pSession) {
                     LOC_LOGI("%s]: gnssNiResponseCommand: send user mResponse %u for id %u",
                              __func__, mResponse, mSessionId);
-                    pthread_mutex_lock(&pSession->tLock);
-                    pSession->resp = mResponse;
-                    pSession->respRecvd = true;
-                    pthread_cond_signal(&pSession->tCond);
-                    pthread_mutex_unlock(&pSession->tLock);
+                    mAdapter.endNiSession(*pSession, mResponse);
                 } else {
                     err = LOCATION_ERROR_ID_UNKNOWN;
                     LOC_LOGE("%s]: gnssNiResponseCommand: id %u not an active session",
@@ -1952,33 +2078,43 @@ GnssAdapter::reportPosition(const UlpLocation& ulpLocation,
             mGnssSvIdUsedInPosAvail = true;
             mGnssSvIdUsedInPosition = locationExtended.gnss_sv_used_ids;
         }
-        for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-            if (nullptr != it->second.trackingCb) {
-                Location location = {};
-                convertLocation(location, ulpLocation.gpsLocation, locationExtended, techMask);
-                it->second.trackingCb(location);
+        if (!mTrackingClients.empty()) {
+            Location location = {};
+            convertLocation(location, ulpLocation.gpsLocation, locationExtended, techMask);
+            // half the engine interval absorbs the jitter between fixes
+            uint32_t tolerance = mTrackingIntervals.empty() ?
+                    0 : mTrackingIntervals.begin()->first / 2;
+            for (auto it=mTrackingClients.begin(); it != mTrackingClients.end(); ++it) {
+                if (isTrackingReportDue(*it, location, tolerance)) {
+                    it->reported = true;
+                    it->lastTimestamp = location.timestamp;
+                    it->lastLatitude = location.latitude;
+                    it->lastLongitude = location.longitude;
+                    it->trackingCb(location);
+                }
             }
-            if (nullptr != it->second.gnssLocationInfoCb) {
-                GnssLocationInfoNotification locationInfo = {};
-                convertLocationInfo(locationInfo, locationExtended);
-                it->second.gnssLocationInfoCb(locationInfo);
+        }
+        if (!mGnssLocationInfoCbs.empty()) {
+            GnssLocationInfoNotification locationInfo = {};
+            convertLocationInfo(locationInfo, locationExtended);
+            for (auto it=mGnssLocationInfoCbs.begin(); it != mGnssLocationInfoCbs.end(); ++it) {
+                (*it)(locationInfo);
             }
         }
         reported = true;
     }
 
-    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER && !mTrackingSessions.empty()) {
+    // the sentences are only generated for an epoch if some client takes them
+    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER && !mTrackingSessions.empty() &&
+        !mGnssNmeaCbs.empty()) {
         /*Only BlankNMEA sentence needs to be processed and sent, if both lat, long is 0 &
           horReliability is not set. */
         bool blank_fix = ((0 == ulpLocation.gpsLocation.latitude) &&
                           (0 == ulpLocation.gpsLocation.longitude) &&
                           (LOC_RELIABILITY_NOT_SET == locationExtended.horizontal_reliability));
         uint8_t generate_nmea = (reported && status != LOC_SESS_FAILURE && !blank_fix);
-        std::vector<std::string> nmeaArraystr;
-        loc_nmea_generate_pos(ulpLocation, locationExtended, generate_nmea, nmeaArraystr);
-        for (auto sentence : nmeaArraystr) {
-            reportNmea(sentence.c_str(), sentence.length());
-        }
+        mNmeaContext.generatePos(ulpLocation, locationExtended, generate_nmea);
+        reportNmea(mNmeaContext.getSentences());
     }
 
     // Free the allocated memory for rawData
@@ -2071,17 +2207,18 @@ GnssAdapter::reportSv(GnssSvNotification& svNotify)
         }
     }
 
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssSvCb) {
-            it->second.gnssSvCb(svNotify);
-        }
+    for (auto it=mGnssSvCbs.begin(); it != mGnssSvCbs.end(); ++it) {
+        (*it)(svNotify);
     }
 
-    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER && !mTrackingSessions.empty()) {
-        std::vector<std::string> nmeaArraystr;
-        loc_nmea_generate_sv(svNotify, nmeaArraystr);
-        for (auto sentence : nmeaArraystr) {
-            reportNmea(sentence.c_str(), sentence.length());
+    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER) {
+        // the SV cache feeds the $--GSA of the next position, so it is kept
+        // current even while no client takes the sentences
+        if (!mTrackingSessions.empty() && !mGnssNmeaCbs.empty()) {
+            mNmeaContext.generateSv(svNotify);
+            reportNmea(mNmeaContext.getSentences());
+        } else {
+            mNmeaContext.updateSvCache(svNotify);
         }
     }
 
@@ -2129,12 +2266,18 @@ GnssAdapter::reportNmeaEvent(const char* nmea, size_t length, bool fromUlp)
         }
     };
 
-    sendMsg(new MsgReportNmea(*this, nmea, length));
+    // debug NMEA only feeds SystemStatus, it can wait behind fixes
+    sendMsg(new MsgReportNmea(*this, nmea, length),
+            loc_nmea_is_debug(nmea, length) ? LOC_MSG_PRIORITY_BULK : LOC_MSG_PRIORITY_DEFAULT);
 }
 
 void
 GnssAdapter::reportNmea(const char* nmea, size_t length)
 {
+    if (mGnssNmeaCbs.empty()) {
+        return;
+    }
+
     GnssNmeaNotification nmeaNotification = {};
     nmeaNotification.size = sizeof(GnssNmeaNotification);
 
@@ -2145,9 +2288,32 @@ GnssAdapter::reportNmea(const char* nmea, size_t length)
     nmeaNotification.nmea = nmea;
     nmeaNotification.length = length;
 
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssNmeaCb) {
-            it->second.gnssNmeaCb(nmeaNotification);
+    for (auto it=mGnssNmeaCbs.begin(); it != mGnssNmeaCbs.end(); ++it) {
+        (*it)(nmeaNotification);
+    }
+}
+
+void
+GnssAdapter::reportNmea(const LocNmeaSentences& sentences)
+{
+    if (mGnssNmeaCbs.empty() || 0 == sentences.count()) {
+        return;
+    }
+
+    // all sentences of the epoch carry the same timestamp and point into the
+    // generator's buffer, which stays untouched until the next epoch
+    GnssNmeaNotification nmeaNotification = {};
+    nmeaNotification.size = sizeof(GnssNmeaNotification);
+
+    struct timeval tv;
+    gettimeofday(&tv, (struct timezone *) NULL);
+    nmeaNotification.timestamp = tv.tv_sec * 1000LL + tv.tv_usec / 1000;
+
+    for (uint32_t i = 0; i < sentences.count(); i++) {
+        nmeaNotification.nmea = sentences.sentence(i);
+        nmeaNotification.length = sentences.length(i);
+        for (auto it=mGnssNmeaCbs.begin(); it != mGnssNmeaCbs.end(); ++it) {
+            (*it)(nmeaNotification);
         }
     }
 }
@@ -2182,65 +2348,60 @@ GnssAdapter::requestNiNotifyEvent(const GnssNiNotification &notify, const void*
     return true;
 }
 
-static void* niThreadProc(void *args)
+void
+NiSessionTimer::timeOutCallback()
 {
-    NiSession* pSession = (NiSession*)args;
-    int rc = 0;          /* return code from pthread calls */
-
-    struct timeval present_time;
-    struct timespec expire_time;
+    if (NULL != mSession->adapter) {
+        mSession->adapter->gnssNiTimeoutCommand(*mSession, mReqId);
+    }
+}
 
-    pthread_mutex_lock(&pSession->tLock);
-    /* Calculate absolute expire time */
-    gettimeofday(&present_time, NULL);
-    expire_time.tv_sec  = present_time.tv_sec + pSession->respTimeLeft;
-    expire_time.tv_nsec = present_time.tv_usec * 1000;
-    LOC_LOGD("%s]: time out set for abs time %ld with delay %d sec",
-             __func__, (long)expire_time.tv_sec, pSession->respTimeLeft);
+void
+GnssAdapter::gnssNiTimeoutCommand(NiSession& session, uint32_t reqId)
+{
+    LOC_LOGD("%s]: id %u", __func__, reqId);
 
-    while (!pSession->respRecvd) {
-        rc = pthread_cond_timedwait(&pSession->tCond,
-                                    &pSession->tLock,
-                                    &expire_time);
-        if (rc == ETIMEDOUT) {
-            pSession->resp = GNSS_NI_RESPONSE_NO_RESPONSE;
-            LOC_LOGD("%s]: time out after valting for specified time. Ret Val %d",
-                     __func__, rc);
-            break;
+    struct MsgGnssNiTimeout : public LocMsg {
+        GnssAdapter& mAdapter;
+        NiSession& mSession;
+        uint32_t mReqId;
+        inline MsgGnssNiTimeout(GnssAdapter& adapter,
+                                NiSession& session,
+                                uint32_t reqId) :
+            LocMsg(),
+            mAdapter(adapter),
+            mSession(session),
+            mReqId(reqId) {}
+        inline virtual void proc() const {
+            // the session may have been answered or replaced since the
+            // timer went off
+            if (mReqId == mSession.reqID && NULL != mSession.rawRequest) {
+                LOC_LOGD("%s]: time out after waiting %u sec for id %u",
+                         __func__, mSession.respTimeLeft, mReqId);
+                mAdapter.endNiSession(mSession, GNSS_NI_RESPONSE_NO_RESPONSE);
+            }
         }
-    }
-    LOC_LOGD("%s]: Java layer has sent us a user response and return value from "
-             "pthread_cond_timedwait = %d pSession->resp is %u", __func__, rc, pSession->resp);
-    pSession->respRecvd = false; /* Reset the user response flag for the next session*/
+    };
 
-    // adding this check to support modem restart, in which case, we need the thread
-    // to exit without calling sending data. We made sure that rawRequest is NULL in
-    // loc_eng_ni_reset_on_engine_restart()
-    GnssAdapter* adapter = pSession->adapter;
-    GnssNiResponse resp;
-    void* rawRequest = NULL;
-    bool sendResponse = false;
+    sendMsg(new MsgGnssNiTimeout(*this, session, reqId));
+}
 
-    if (NULL != pSession->rawRequest) {
-        if (pSession->resp != GNSS_NI_RESPONSE_IGNORE) {
-            resp = pSession->resp;
-            rawRequest = pSession->rawRequest;
-            sendResponse = true;
+void
+GnssAdapter::endNiSession(NiSession& session, GnssNiResponse response)
+{
+    LOC_LOGD("%s]: id %u response %u", __func__, session.reqID, response);
+
+    session.timer.stop();
+    if (NULL != session.rawRequest) {
+        if (response != GNSS_NI_RESPONSE_IGNORE) {
+            gnssNiResponseCommand(response, session.rawRequest);
         } else {
-            free(pSession->rawRequest);
+            free(session.rawRequest);
         }
-        pSession->rawRequest = NULL;
+        session.rawRequest = NULL;
     }
-    pthread_mutex_unlock(&pSession->tLock);
-
-    pSession->respTimeLeft = 0;
-    pSession->reqID = 0;
-
-    if (sendResponse) {
-        adapter->gnssNiResponseCommand(resp, rawRequest);
-    }
-
-    return NULL;
+    session.respTimeLeft = 0;
+    session.reqID = 0;
 }
 
 bool
@@ -2291,20 +2452,15 @@ GnssAdapter::requestNiNotify(const GnssNiNotification& notify, const void* data)
 
         int sessionId = pSession->reqID;
 
-        /* For robustness, spawn a thread at this point to timeout to clear up the notification
+        /* For robustness, start a timer at this point to timeout to clear up the notification
          * status, even though the OEM layer in java does not do so.
          **/
         pSession->respTimeLeft =
              5 + (notify.timeout != 0 ? notify.timeout : LOC_NI_NO_RESPONSE_TIME);
+        LOC_LOGD("%s]: time out set with delay %u sec", __func__, pSession->respTimeLeft);
 
-        int rc = 0;
-        rc = pthread_create(&pSession->thread, NULL, niThreadProc, pSession);
-        if (rc) {
-            LOC_LOGE("%s]: Loc NI thread is not created.", __func__);
-        }
-        rc = pthread_detach(pSession->thread);
-        if (rc) {
-            LOC_LOGE("%s]: Loc NI thread is not detached.", __func__);
+        if (!pSession->timer.start(pSession->reqID, pSession->respTimeLeft * 1000)) {
+            LOC_LOGE("%s]: Loc NI timer is not started.", __func__);
         }
 
         if (nullptr != gnssNiCb) {
@@ -2339,16 +2495,15 @@ GnssAdapter::reportGnssMeasurementDataEvent(const GnssMeasurementsNotification&
         }
     };
 
-    sendMsg(new MsgReportGnssMeasurementData(*this, measurements, msInWeek));
+    sendMsg(new MsgReportGnssMeasurementData(*this, measurements, msInWeek),
+            LOC_MSG_PRIORITY_BULK);
 }
 
 void
 GnssAdapter::reportGnssMeasurementData(const GnssMeasurementsNotification& measurements)
 {
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssMeasurementsCb) {
-            it->second.gnssMeasurementsCb(measurements);
-        }
+    for (auto it=mGnssMeasurementsCbs.begin(); it != mGnssMeasurementsCbs.end(); ++it) {
+        (*it)(measurements);
     }
 }
 
@@ -2858,13 +3013,18 @@ bool GnssAdapter::getDebugReport(GnssDebugReport& r)
 {
     LOC_LOGD("%s]: ", __func__);
 
+    // only logged at debug level by the debug HAL, not worth building otherwise
+    IF_LOC_LOGD {
+        mMsgTask->dumpStats(r.mMsgTaskStats);
+    }
+
     SystemStatus* systemstatus = getSystemStatus();
     if (nullptr == systemstatus) {
         return false;
     }
 
-    SystemStatusReports reports = {};
-    systemstatus->getReport(reports, true);
+    std::shared_ptr<const SystemStatusReports> snapshot = systemstatus->getReportSnapshot();
+    const SystemStatusReports& reports = *snapshot;
 
     r.size = sizeof(r);
 
@@ -2961,8 +3121,9 @@ GnssAdapter::getAgcInformation(GnssMeasurementsNotification& measurements, int m
     SystemStatus* systemstatus = getSystemStatus();
 
     if (nullptr != systemstatus) {
-        SystemStatusReports reports = {};
-        systemstatus->getReport(reports, true);
+        std::shared_ptr<const SystemStatusReports> snapshot =
+                systemstatus->getReportSnapshot();
+        const SystemStatusReports& reports = *snapshot;
 
         if ((!reports.mRfAndParams.empty()) && (!reports.mTimeAndClock.empty()) &&
             reports.mTimeAndClock.back().mTimeValid &&
@@ -36,6 +36,9 @@
 #include <Agps.h>
 #include <SystemStatus.h>
 #include <XtraSystemStatusObserver.h>
+#include <loc_nmea.h>
+#include <LocTimer.h>
+#include <set>
 
 #define MAX_URL_LEN 256
 #define NMEA_SENTENCE_MAX_LENGTH 200
@@ -43,20 +46,43 @@
 #define MAX_SATELLITES_IN_USE 12
 #define LOC_NI_NO_RESPONSE_TIME 20
 #define LOC_GPS_NI_RESPONSE_IGNORE 4
+#define LOC_NI_TIMEOUT_SLACK_MS 1000
+// the reports GnssAdapter passes on to ULP and SystemStatus, whatever its
+// clients registered for
+#define GNSS_ADAPTER_FORWARDED_MASK (LOC_API_ADAPTER_BIT_PARSED_POSITION_REPORT | \
+                                     LOC_API_ADAPTER_BIT_SATELLITE_REPORT | \
+                                     LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT | \
+                                     LOC_API_ADAPTER_BIT_NMEA_POSITION_REPORT | \
+                                     LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT | \
+                                     LOC_API_ADAPTER_BIT_GNSS_SV_POLYNOMIAL_REPORT)
 
 class GnssAdapter;
+struct NiSession;
 
-typedef struct {
-    pthread_t               thread;        /* NI thread */
+// Expires an NI session that got no user response in time; runs on the
+// timer thread and hands the expiry over to the adapter's msg task.
+class NiSessionTimer : public LocTimer {
+    NiSession* mSession;
+    uint32_t mReqId;
+public:
+    inline NiSessionTimer(NiSession* session) : LocTimer(), mSession(session), mReqId(0) {}
+    inline bool start(uint32_t reqId, uint32_t timeOutInMs) {
+        mReqId = reqId;
+        // the response window is several seconds, a second late does not matter
+        return LocTimer::start(timeOutInMs, false, LOC_NI_TIMEOUT_SLACK_MS);
+    }
+    virtual void timeOutCallback();
+};
+
+struct NiSession {
     uint32_t                respTimeLeft;  /* examine time for NI response */
-    bool                    respRecvd;     /* NI User reponse received or not from Java layer*/
     void*                   rawRequest;
     uint32_t                reqID;         /* ID to check against response */
-    GnssNiResponse          resp;
-    pthread_cond_t          tCond;
-    pthread_mutex_t         tLock;
     GnssAdapter*            adapter;
-} NiSession;
+    NiSessionTimer          timer;         /* NI response timeout */
+    inline NiSession() :
+        respTimeLeft(0), rawRequest(NULL), reqID(0), adapter(NULL), timer(this) {}
+};
 typedef struct {
     NiSession session;    /* SUPL NI Session */
     NiSession sessionEs;  /* Emergency SUPL NI Session */
@@ -87,9 +113,32 @@ class GnssAdapter : public LocAdapterBase {
     /* ==== CLIENT ========================================================================= */
     typedef std::map<LocationAPI*, LocationCallbacks> ClientDataMap;
     ClientDataMap mClientData;
+    // a client's trackingCb gets a fix only once its fastest tracking session
+    // is due, so slow clients are not woken at the multiplexed engine rate
+    typedef struct {
+        LocationAPI* client;
+        trackingCallback trackingCb;
+        uint32_t minInterval;    // smallest of the client's tracking sessions, ms
+        uint32_t minDistance;    // smallest of the client's tracking sessions, m
+        bool reported;           // last* below are valid
+        uint64_t lastTimestamp;  // of the last fix reported to the client
+        double lastLatitude;
+        double lastLongitude;
+    } TrackingClient;
+    // callbacks of each kind the clients registered, rebuilt from mClientData
+    // on every change so the reports only walk the clients that want them
+    std::vector<TrackingClient> mTrackingClients;
+    std::vector<gnssLocationInfoCallback> mGnssLocationInfoCbs;
+    std::vector<gnssSvCallback> mGnssSvCbs;
+    std::vector<gnssNmeaCallback> mGnssNmeaCbs;
+    std::vector<gnssMeasurementsCallback> mGnssMeasurementsCbs;
 
     /* ==== TRACKING ======================================================================= */
     LocationSessionMap mTrackingSessions;
+    // minInterval and key of every tracking session, kept in step with
+    // mTrackingSessions; the first one is the session the engine runs
+    typedef std::set<std::pair<uint32_t, LocationSessionKey>> TrackingIntervalSet;
+    TrackingIntervalSet mTrackingIntervals;
     LocPosMode mUlpPositionMode;
     GnssSvUsedInPosition mGnssSvIdUsedInPosition;
     bool mGnssSvIdUsedInPosAvail;
@@ -98,6 +147,8 @@ class GnssAdapter : public LocAdapterBase {
     LocationControlCallbacks mControlCallbacks;
     uint32_t mPowerVoteId;
     uint32_t mNmeaMask;
+    // NMEA generation state, reused for every report on the adapter thread
+    NmeaContext mNmeaContext;
 
     /* ==== NI ============================================================================= */
     NiData mNiData;
@@ -145,6 +196,7 @@ public:
     /* ======== UTILITIES ================================================================== */
     void saveClient(LocationAPI* client, const LocationCallbacks& callbacks);
     void eraseClient(LocationAPI* client);
+    void updateClientCallbacks();
     void updateClientsEventMask();
     void stopClientSessions(LocationAPI* client);
     LocationCallbacks getClientCallbacks(LocationAPI* client);
@@ -170,6 +222,10 @@ public:
     void saveTrackingSession(LocationAPI* client, uint32_t sessionId,
                              const LocationOptions& options);
     void eraseTrackingSession(LocationAPI* client, uint32_t sessionId);
+    const LocationOptions* getSmallestIntervalOptions(const LocationSessionKey* excluded);
+    void updateTrackingClient(LocationAPI* client, bool sessionStarted = false);
+    static bool isTrackingReportDue(const TrackingClient& trackingClient,
+                                    const Location& location, uint32_t tolerance);
     void setUlpPositionMode(const LocPosMode& mode) { mUlpPositionMode = mode; }
     LocPosMode& getUlpPositionMode() { return mUlpPositionMode; }
     LocationError startTrackingMultiplex(const LocationOptions& options);
@@ -182,9 +238,11 @@ public:
     /* ==== NI ============================================================================= */
     /* ======== COMMANDS ====(Called from Client Thread)==================================== */
     void gnssNiResponseCommand(LocationAPI* client, uint32_t id, GnssNiResponse response);
-    /* ======================(Called from NI Thread)======================================== */
-    void gnssNiResponseCommand(GnssNiResponse response, void* rawRequest);
+    /* ======================(Called from NI Timer Thread)================================== */
+    void gnssNiTimeoutCommand(NiSession& session, uint32_t reqId);
     /* ======== UTILITIES ================================================================== */
+    void gnssNiResponseCommand(GnssNiResponse response, void* rawRequest);
+    void endNiSession(NiSession& session, GnssNiResponse response);
     bool hasNiNotifyCallback(LocationAPI* client);
     NiData& getNiData() { return mNiData; }
 
@@ -244,6 +302,7 @@ public:
                         LocPosTechMask techMask);
     void reportSv(GnssSvNotification& svNotify);
     void reportNmea(const char* nmea, size_t length);
+    void reportNmea(const LocNmeaSentences& sentences);
     bool requestNiNotify(const GnssNiNotification& notify, const void* data);
     void reportGnssMeasurementData(const GnssMeasurementsNotification& measurements);
 
@@ -277,9 +336,7 @@ public:
     void injectLocationCommand(double latitude, double longitude, float accuracy);
     void injectTimeCommand(int64_t time, int64_t timeReference, int32_t uncertainty);
 
-    inline void updateConnectionStatusCommand(bool connected, uint8_t type) {
-        mXtraObserver.updateConnectionStatus(connected, type);
-    }
+    void updateConnectionStatusCommand(bool connected, uint8_t type);
 
 };
 
@@ -43,7 +43,6 @@
 #include <loc_nmea.h>
 #include <SystemStatus.h>
 #include <vector>
-#include <sstream>
 #include <XtraSystemStatusObserver.h>
 #include <LocAdapterBase.h>
 
@@ -51,37 +50,195 @@ using namespace std;
 using namespace loc_core;
 
 #define XTRA_HAL_SOCKET_NAME "/data/vendor/location/xtra/socket_hal_xtra"
+#define XTRA_HAL_RECONNECT_MIN_MS (1000)
+#define XTRA_HAL_RECONNECT_MAX_MS (64000)
+// "gpslock <lock>\n" plus "connection <0|1> <type>\n" for each type
+#define XTRA_HAL_EVENT_MAXSIZE (32)
+
+XtraSystemStatusObserver::XtraSystemStatusObserver(const MsgTask* msgTask) :
+    mMsgTask(msgTask),
+    mSocketFd(-1),
+    mFlushPending(false),
+    mReconnectPending(false),
+    mReconnectDelayMs(XTRA_HAL_RECONNECT_MIN_MS),
+    mReconnectTimer(this),
+    mLockKnown(false),
+    mLockDirty(false),
+    mLock(0)
+{
+}
+
+XtraSystemStatusObserver::~XtraSystemStatusObserver() {
+    mReconnectTimer.stop();
+    closeSocket(mSocketFd);
+    mSocketFd = -1;
+}
 
 bool XtraSystemStatusObserver::updateLockStatus(uint32_t lock) {
-    std::stringstream ss;
-    ss <<  "gpslock";
-    ss << " " << lock;
-    ss << "\n"; // append seperator
-    return ( sendEvent(ss) );
+    if (mLockKnown && mLock == lock) {
+        return false;
+    }
+    mLockKnown = true;
+    mLock = lock;
+    mLockDirty = true;
+    scheduleFlush();
+    return true;
 }
 
 bool XtraSystemStatusObserver::updateConnectionStatus(bool connected, uint8_t type) {
-    std::stringstream ss;
-    ss <<  "connection";
-    ss << " " << (connected ? "1" : "0");
-    ss << " " << (int)type;
-    ss << "\n"; // append seperator
-    return ( sendEvent(ss) );
+    for (auto it = mConnections.begin(); it != mConnections.end(); ++it) {
+        if (it->mType == type) {
+            if (it->mConnected == connected) {
+                return false;
+            }
+            it->mConnected = connected;
+            it->mDirty = true;
+            scheduleFlush();
+            return true;
+        }
+    }
+    ConnectionStatus status = {type, connected, true};
+    mConnections.push_back(status);
+    scheduleFlush();
+    return true;
+}
+
+void XtraSystemStatusObserver::scheduleFlush() {
+    struct HandleFlush : public LocMsg {
+        XtraSystemStatusObserver& mObserver;
+        inline HandleFlush(XtraSystemStatusObserver& observer) :
+            LocMsg(), mObserver(observer) {}
+        inline virtual void proc() const {
+            mObserver.mFlushPending = false;
+            mObserver.flush();
+        }
+    };
+    // updates already queued behind this one are picked up by the same flush
+    if (!mFlushPending && !mReconnectPending) {
+        mFlushPending = true;
+        mMsgTask->sendMsg(new (nothrow) HandleFlush(*this));
+    }
+}
+
+void XtraSystemStatusObserver::ReconnectTimer::timeOutCallback() {
+    struct HandleReconnect : public LocMsg {
+        XtraSystemStatusObserver& mObserver;
+        inline HandleReconnect(XtraSystemStatusObserver& observer) :
+            LocMsg(), mObserver(observer) {}
+        inline virtual void proc() const {
+            mObserver.mReconnectPending = false;
+            mObserver.flush();
+        }
+    };
+    // expires on the timer thread, the socket belongs to the msg task
+    mObserver->mMsgTask->sendMsg(new (nothrow) HandleReconnect(*mObserver));
+}
+
+bool XtraSystemStatusObserver::isDirty() const {
+    if (mLockDirty) {
+        return true;
+    }
+    for (auto it = mConnections.begin(); it != mConnections.end(); ++it) {
+        if (it->mDirty) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void XtraSystemStatusObserver::markAllDirty() {
+    mLockDirty = mLockKnown;
+    for (auto it = mConnections.begin(); it != mConnections.end(); ++it) {
+        it->mDirty = true;
+    }
 }
 
-bool XtraSystemStatusObserver::sendEvent(std::stringstream& event) {
-    int socketFd = createSocket();
-    if (socketFd < 0) {
+void XtraSystemStatusObserver::scheduleReconnect() {
+    if (mReconnectPending) {
+        return;
+    }
+    if (mReconnectDelayMs > XTRA_HAL_RECONNECT_MAX_MS) {
+        // the XTRA daemon may not be there at all, leave it to the next update
+        LOC_LOGd("XTRA still unreachable, retrying on the next update");
+        mReconnectDelayMs = XTRA_HAL_RECONNECT_MIN_MS;
+        return;
+    }
+    LOC_LOGd("XTRA reconnect in %u ms", mReconnectDelayMs);
+    // a retry a quarter of the delay late is as good as on time
+    mReconnectPending = mReconnectTimer.start(mReconnectDelayMs, false,
+                                              mReconnectDelayMs / 4);
+    mReconnectDelayMs *= 2;
+}
+
+void XtraSystemStatusObserver::buildEvent(std::vector<char>& event) {
+    char line[XTRA_HAL_EVENT_MAXSIZE];
+    int len = 0;
+    event.clear();
+    if (mLockDirty) {
+        len = snprintf(line, sizeof(line), "gpslock %u\n", mLock);
+        event.insert(event.end(), line, line + len);
+    }
+    for (auto it = mConnections.begin(); it != mConnections.end(); ++it) {
+        if (it->mDirty) {
+            len = snprintf(line, sizeof(line), "connection %d %d\n",
+                           it->mConnected ? 1 : 0, (int)it->mType);
+            event.insert(event.end(), line, line + len);
+        }
+    }
+}
+
+void XtraSystemStatusObserver::flush() {
+    // nothing unsent, nothing to connect for
+    if (mReconnectPending || !isDirty()) {
+        return;
+    }
+
+    // a connection dropped by the peer only shows when writing to it, so
+    // a failed write on an old connection gets one fresh connection at once
+    std::vector<char> event;
+    bool sent = false;
+    for (int attempt = 0; attempt < 2 && !sent; attempt++) {
+        bool reused = (mSocketFd >= 0);
+        if (!reused) {
+            mSocketFd = createSocket();
+            if (mSocketFd < 0) {
+                break;
+            }
+            // the other end may have restarted and lost it all, replay it
+            markAllDirty();
+        }
+        buildEvent(event);
+        if (event.empty()) {
+            return;
+        }
+        sent = sendEvent(event.data(), event.size());
+        if (!sent) {
+            closeSocket(mSocketFd);
+            mSocketFd = -1;
+            if (!reused) {
+                break;
+            }
+        }
+    }
+
+    if (sent) {
+        mReconnectDelayMs = XTRA_HAL_RECONNECT_MIN_MS;
+        mLockDirty = false;
+        for (auto it = mConnections.begin(); it != mConnections.end(); ++it) {
+            it->mDirty = false;
+        }
+    } else {
         LOC_LOGe("XTRA unreachable. sending failed.");
-        return false;
+        scheduleReconnect();
     }
+}
 
-    const std::string& data = event.str();
-    int remain = data.length();
+bool XtraSystemStatusObserver::sendEvent(const char* data, size_t length) {
+    size_t remain = length;
     ssize_t sent = 0;
 
     while (remain > 0 &&
-          (sent = ::send(socketFd, data.c_str() + (data.length() - remain),
+          (sent = ::send(mSocketFd, data + (length - remain),
                        remain, MSG_NOSIGNAL)) > 0) {
         remain -= sent;
     }
@@ -90,12 +247,9 @@ bool XtraSystemStatusObserver::sendEvent(std::stringstream& event) {
         LOC_LOGe("sending error. reason:%s", strerror(errno));
     }
 
-    closeSocket(socketFd);
-
     return (remain == 0);
 }
 
-
 int XtraSystemStatusObserver::createSocket() {
     int socketFd = -1;
 
@@ -30,25 +30,67 @@
 #define XTRA_SYSTEM_STATUS_OBS_H
 
 #include <stdint.h>
+#include <vector>
+#include <MsgTask.h>
+#include <LocTimer.h>
 
-
+// Keeps one connection to the XTRA HAL socket, owned by the msg task it is
+// given. Status updates only record the latest lock and per type connection
+// state and schedule a flush, so a burst of updates queued on the msg task
+// goes out as one write. A lost connection is retried with a growing delay
+// while there is state left unsent, up to the longest delay, after which
+// only the next update tries again. The whole known state is replayed on
+// each new connection.
 class XtraSystemStatusObserver {
 public :
     // constructor & destructor
-    XtraSystemStatusObserver() {
-    }
-
-    virtual ~XtraSystemStatusObserver() {
-    }
+    XtraSystemStatusObserver(const MsgTask* msgTask);
+    virtual ~XtraSystemStatusObserver();
 
+    // msg task thread only. Return true if the status changed and is to be
+    // sent, false if it is the one already known.
     bool updateLockStatus(uint32_t lock);
     bool updateConnectionStatus(bool connected, uint8_t type);
 
 private:
+    struct ConnectionStatus {
+        uint8_t mType;
+        bool mConnected;
+        bool mDirty;
+    };
+
+    class ReconnectTimer : public LocTimer {
+    public:
+        inline ReconnectTimer(XtraSystemStatusObserver* observer) :
+            LocTimer(), mObserver(observer) {}
+        virtual void timeOutCallback();
+    private:
+        XtraSystemStatusObserver* mObserver;
+    };
+
+    // msg task thread only
+    void scheduleFlush();
+    void flush();
+    void buildEvent(std::vector<char>& event);
+    bool isDirty() const;
+    void markAllDirty();
+    void scheduleReconnect();
     int createSocket();
     void closeSocket(const int32_t socketFd);
-    bool sendEvent(std::stringstream& event);
+    bool sendEvent(const char* data, size_t length);
+
+    const MsgTask* mMsgTask;
+    int mSocketFd;
+    bool mFlushPending;
+    bool mReconnectPending;
+    uint32_t mReconnectDelayMs;
+    ReconnectTimer mReconnectTimer;
 
+    // last known state, what is dirty has not been written yet
+    bool mLockKnown;
+    bool mLockDirty;
+    uint32_t mLock;
+    std::vector<ConnectionStatus> mConnections;
 };
 
 #endif
@@ -30,6 +30,7 @@
 #define LOCATION_H
 
 #include <vector>
+#include <string>
 #include <stdint.h>
 #include <functional>
 #include <list>
@@ -651,6 +652,8 @@ typedef struct {
     GnssDebugLocation                   mLocation;
     GnssDebugTime                       mTime;
     std::vector<GnssDebugSatelliteInfo> mSatelliteInfo;
+    std::string                         mMsgTaskStats; // text, see MsgTask::dumpStats(),
+                                                       // only filled at debug log level
 } GnssDebugReport;
 
 /* Provides the capabilities of the system
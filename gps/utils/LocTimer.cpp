@@ -35,8 +35,8 @@
 #include <sys/timerfd.h>
 #include <sys/epoll.h>
 #include <unistd.h>
+#include <vector>
 #include <LocTimer.h>
-#include <LocHeap.h>
 #include <LocThread.h>
 #include <LocSharedLock.h>
 #include <MsgTask.h>
@@ -53,24 +53,29 @@ LocTimer, LocTimerDelegate, LocTimerContainer, LocTimerPollTask, LocTimerWrapper
 
 LocTimer - client front end, interface for client to start / stop timers, also
            to provide a callback.
-LocTimerDelegate - an internal timer entity, which also is a LocRankable obj.
-                   Its life cycle is different than that of LocTimer. It gets
-                   created when LocTimer::start() is called, and gets deleted
-                   when it expires or clients calls the hosting LocTimer obj's
-                   stop() method. When a LocTimerDelegate obj is ticking, it
-                   stays in the corresponding LocTimerContainer. When expired
-                   or stopped, the obj is removed from the container. Since it
-                   is also a LocRankable obj, and LocTimerContainer also is a
-                   heap, its ranks() implementation decides where it is placed
-                   in the heap.
-LocTimerContainer - core of the timer service. It is a container (derived from
-                    LocHeap) for LocTimerDelegate (implements LocRankable) objs.
+LocTimerDelegate - an internal timer entity. Its life cycle is different than
+                   that of LocTimer. It gets created when LocTimer::start() is
+                   called, and gets deleted when it expires or clients calls the
+                   hosting LocTimer obj's stop() method. Deleted objs are kept
+                   for reuse by later start() calls. When a LocTimerDelegate obj
+                   is ticking, it stays in the corresponding LocTimerContainer,
+                   and knows its own slot in the container's heap. When expired
+                   or stopped, the obj is removed from the container.
+LocTimerContainer - core of the timer service. It is a container, an array
+                    backed 4-ary heap ordered by expiry time, for
+                    LocTimerDelegate objs. Insertion and removal (by slot
+                    index, no search) are O(log n) and do not allocate once
+                    the array has grown to the peak timer count.
                     There are 2 of such containers, one for sw timers (or Linux
-                    timers) one for hw timers (or Linux alarms). It adds one of
-                    each (those that expire the soonest) to kernel via services
-                    provided by LocTimerPollTask. All the heap management on the
-                    LocTimerDelegate objs are done in the MsgTask context, such
-                    that synchronization is ensured.
+                    timers) one for hw timers (or Linux alarms). It adds one
+                    wake up time for each to kernel via services provided by
+                    LocTimerPollTask. A timer started with slack may expire
+                    anywhere within [timeout, timeout + slack], so the wake up
+                    time is the earliest end of all such windows, and one wake
+                    up expires every timer whose window has opened by then.
+                    All the heap management on the LocTimerDelegate objs are
+                    done in the MsgTask context, such that synchronization is
+                    ensured.
 LocTimerPollTask - is a class that wraps timerfd and epoll POXIS APIs. It also
                    both implements LocRunnalbe with epoll_wait() in the run()
                    method. It is also a LocThread client, so as to loop the run
@@ -83,14 +88,14 @@ LocTimerWrapper - a LocTimer client itself, to implement the existing C API with
 class LocTimerPollTask;
 
 // This is a multi-functaional class that:
-// * extends the LocHeap class for the detection of head update upon add / remove
-//   events. When that happens, soonest time out changes, so timerfd needs update.
+// * keeps the timers in a heap, and detects wake up time update upon add /
+//   remove events. When that happens, timerfd needs update.
 // * contains the timers, and add / remove them into the heap
 // * provides and maps 2 of such containers, one for timers (or  mSwTimers), one
 //   for alarms (or mHwTimers);
 // * provides a polling thread;
 // * provides a MsgTask thread for synchronized add / remove / timer client callback.
-class LocTimerContainer : public LocHeap {
+class LocTimerContainer {
     // mutex to synchronize getters of static members
     static pthread_mutex_t mMutex;
     // Container of timers
@@ -103,16 +108,33 @@ class LocTimerContainer : public LocHeap {
     static LocTimerPollTask* mPollTask;
     // timer / alarm fd
     int mDevFd;
+    // 4-ary min heap on expiry time of the ticking timers. Each timer
+    // records its index in here, in LocTimerDelegate::mHeapIndex.
+    std::vector<LocTimerDelegate*> mTimers;
+    // the time mDevFd is armed to go off at, valid only if mArmed
+    struct timespec mWakeTime;
+    bool mArmed;
     // ctor
     LocTimerContainer(bool wakeOnExpire);
     // dtor
     ~LocTimerContainer();
     static MsgTask* getMsgTaskLocked();
     static LocTimerPollTask* getPollTaskLocked();
-    // extend LocHeap and pop if the top outRanks input
-    LocTimerDelegate* popIfOutRanks(LocTimerDelegate& timer);
-    // update the timer POSIX calls with updated soonest timer spec
-    void updateSoonestTime(LocTimerDelegate* priorTop);
+    inline void place(size_t index, LocTimerDelegate* timer);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    // heap operations, all O(log n)
+    void push(LocTimerDelegate& timer);
+    LocTimerDelegate* pop();
+    // returns true if the timer was in the heap
+    bool removeFromHeap(LocTimerDelegate& timer);
+    // pop the top if it expires at or before the input time
+    LocTimerDelegate* popIfExpired(const struct timespec& now);
+    // earliest latest-expiry-time among the timers in the subtree at index
+    void findWakeTime(size_t index, struct timespec& wakeTime);
+    // rearm the timer POSIX calls if the wake up time has changed. If the
+    // only change is a newly added timer, it is passed in.
+    void updateWakeTime(LocTimerDelegate* addedTimer);
 
 public:
     // factory method to control the creation of mSwTimers / mHwTimers
@@ -168,30 +190,45 @@ public:
     virtual bool run();
 };
 
+// true if time a is before time b
+static inline bool isBefore(const struct timespec& a, const struct timespec& b) {
+    return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
 // Internal class of timer obj. It gets born when client calls LocTimer::start();
 // and gets deleted when client calls LocTimer::stop() or when the it expire()'s.
-// This class implements LocRankable::ranks() so that when an obj is added into
-// the container (of LocHeap), it gets placed in sorted order.
-class LocTimerDelegate : public LocRankable {
+// While ticking, mHeapIndex is its slot in the container heap, so that it can
+// be removed without searching the heap.
+class LocTimerDelegate {
     friend class LocTimerContainer;
     friend class LocTimer;
     LocTimer* mClient;
     LocSharedLock* mLock;
     struct timespec mFutureTime;
+    // mFutureTime + slack, the latest it may expire
+    struct timespec mLatestTime;
     LocTimerContainer* mContainer;
-    // not a complete obj, just ctor for LocRankable comparisons
-    inline LocTimerDelegate(struct timespec& delay)
-        : mClient(NULL), mLock(NULL), mFutureTime(delay), mContainer(NULL) {}
+    size_t mHeapIndex;
+    // free list of deleted objs, for reuse by operator new
+    static pthread_mutex_t mFreeMutex;
+    static LocTimerDelegate* mFree;
     inline ~LocTimerDelegate() { if (mLock) { mLock->drop(); mLock = NULL; } }
 public:
-    LocTimerDelegate(LocTimer& client, struct timespec& futureTime, LocTimerContainer* container);
+    LocTimerDelegate(LocTimer& client, struct timespec& futureTime,
+                     struct timespec& latestTime, LocTimerContainer* container);
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
     void destroyLocked();
-    // LocRankable virtual method
-    virtual int ranks(LocRankable& rankable);
+    // true if this expires before the input timer
+    inline bool isSooner(const struct timespec& time) { return isBefore(mFutureTime, time); }
+    inline bool isSooner(LocTimerDelegate& timer) { return isSooner(timer.mFutureTime); }
     void expire();
     inline struct timespec getFutureTime() { return mFutureTime; }
 };
 
+#define LOC_TIMER_NOT_IN_HEAP ((size_t)-1)
+#define LOC_TIMER_HEAP_ARITY 4
+
 /***************************LocTimerContainer methods***************************/
 
 // Most of these static recources are created on demand. They however are never
@@ -209,7 +246,9 @@ LocTimerPollTask* LocTimerContainer::mPollTask = NULL;
 // A container for swTimer (timer) is created, when wakeOnExpire is true; or
 // HwTimer (alarm), when wakeOnExpire is false.
 LocTimerContainer::LocTimerContainer(bool wakeOnExpire) :
-    mDevFd(timerfd_create(wakeOnExpire ? CLOCK_BOOTTIME_ALARM : CLOCK_BOOTTIME, 0)) {
+    mDevFd(timerfd_create(wakeOnExpire ? CLOCK_BOOTTIME_ALARM : CLOCK_BOOTTIME, 0)),
+    mArmed(false) {
+    memset(&mWakeTime, 0, sizeof(mWakeTime));
 
     if ((-1 == mDevFd) && (errno == EINVAL)) {
         LOC_LOGW("%s: timerfd_create failure, fallback to CLOCK_MONOTONIC - %s",
@@ -271,7 +310,84 @@ LocTimerPollTask* LocTimerContainer::getPollTaskLocked() {
 
 inline
 LocTimerDelegate* LocTimerContainer::getSoonestTimer() {
-    return (LocTimerDelegate*)(peek());
+    return mTimers.empty() ? NULL : mTimers[0];
+}
+
+inline
+void LocTimerContainer::place(size_t index, LocTimerDelegate* timer) {
+    mTimers[index] = timer;
+    timer->mHeapIndex = index;
+}
+
+void LocTimerContainer::siftUp(size_t index) {
+    LocTimerDelegate* timer = mTimers[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / LOC_TIMER_HEAP_ARITY;
+        if (!timer->isSooner(*mTimers[parent])) {
+            break;
+        }
+        place(index, mTimers[parent]);
+        index = parent;
+    }
+    place(index, timer);
+}
+
+void LocTimerContainer::siftDown(size_t index) {
+    LocTimerDelegate* timer = mTimers[index];
+    size_t size = mTimers.size();
+    for (;;) {
+        size_t first = index * LOC_TIMER_HEAP_ARITY + 1;
+        if (first >= size) {
+            break;
+        }
+        size_t soonest = first;
+        size_t last = first + LOC_TIMER_HEAP_ARITY;
+        for (size_t child = first + 1; child < last && child < size; child++) {
+            if (mTimers[child]->isSooner(*mTimers[soonest])) {
+                soonest = child;
+            }
+        }
+        if (!mTimers[soonest]->isSooner(*timer)) {
+            break;
+        }
+        place(index, mTimers[soonest]);
+        index = soonest;
+    }
+    place(index, timer);
+}
+
+void LocTimerContainer::push(LocTimerDelegate& timer) {
+    mTimers.push_back(&timer);
+    siftUp(mTimers.size() - 1);
+}
+
+LocTimerDelegate* LocTimerContainer::pop() {
+    LocTimerDelegate* top = getSoonestTimer();
+    if (top) {
+        removeFromHeap(*top);
+    }
+    return top;
+}
+
+bool LocTimerContainer::removeFromHeap(LocTimerDelegate& timer) {
+    size_t index = timer.mHeapIndex;
+    if (index >= mTimers.size() || mTimers[index] != &timer) {
+        return false;
+    }
+    timer.mHeapIndex = LOC_TIMER_NOT_IN_HEAP;
+
+    LocTimerDelegate* last = mTimers.back();
+    mTimers.pop_back();
+    if (last != &timer) {
+        // move the last timer into the vacated slot, then restore order
+        place(index, last);
+        if (index > 0 && last->isSooner(*mTimers[(index - 1) / LOC_TIMER_HEAP_ARITY])) {
+            siftUp(index);
+        } else {
+            siftDown(index);
+        }
+    }
+    return true;
 }
 
 inline
@@ -279,31 +395,62 @@ int LocTimerContainer::getTimerFd() {
     return mDevFd;
 }
 
-void LocTimerContainer::updateSoonestTime(LocTimerDelegate* priorTop) {
-    LocTimerDelegate* curTop = getSoonestTimer();
+// Visits only the timers that open their window before the best wake up time
+// found so far, as the heap order guarantees no one in their subtree can do
+// better. With no or little slack, that is just the top of the heap.
+void LocTimerContainer::findWakeTime(size_t index, struct timespec& wakeTime) {
+    LocTimerDelegate* timer = mTimers[index];
+    if (isBefore(timer->mFutureTime, wakeTime)) {
+        if (isBefore(timer->mLatestTime, wakeTime)) {
+            wakeTime = timer->mLatestTime;
+        }
+        size_t first = index * LOC_TIMER_HEAP_ARITY + 1;
+        size_t last = first + LOC_TIMER_HEAP_ARITY;
+        for (size_t child = first; child < last && child < mTimers.size(); child++) {
+            findWakeTime(child, wakeTime);
+        }
+    }
+}
+
+void LocTimerContainer::updateWakeTime(LocTimerDelegate* addedTimer) {
+    struct itimerspec delay;
+    memset(&delay, 0, sizeof(struct itimerspec));
+    bool toSetTime = false;
 
-    // check if top has changed
-    if (curTop != priorTop) {
-        struct itimerspec delay;
-        memset(&delay, 0, sizeof(struct itimerspec));
-        bool toSetTime = false;
+    if (mTimers.empty()) {
         // if tree is empty now, we remove poll and disarm timer
-        if (!curTop) {
+        if (mArmed) {
             mPollTask->removePoll(*this);
-            // setting the values to disarm timer
-            delay.it_value.tv_sec = 0;
-            delay.it_value.tv_nsec = 0;
+            mArmed = false;
             toSetTime = true;
-        } else if (!priorTop || curTop->outRanks(*priorTop)) {
+        }
+    } else {
+        struct timespec wakeTime;
+        if (mArmed && NULL != addedTimer) {
+            // the new timer can only pull the wake up time in
+            wakeTime = mWakeTime;
+            if (isBefore(addedTimer->mLatestTime, wakeTime)) {
+                wakeTime = addedTimer->mLatestTime;
+            }
+        } else {
+            wakeTime = mTimers[0]->mLatestTime;
+            findWakeTime(0, wakeTime);
+        }
+        // a timer whose window covers the current wake up time joins that
+        // wake up, so kernel only needs an update if the time moved
+        if (!mArmed || isBefore(wakeTime, mWakeTime) || isBefore(mWakeTime, wakeTime)) {
             // do this first to avoid race condition, in case settime is called
             // with too small an interval
             mPollTask->addPoll(*this);
-            delay.it_value = curTop->getFutureTime();
+            delay.it_value = wakeTime;
+            mWakeTime = wakeTime;
+            mArmed = true;
             toSetTime = true;
         }
-        if (toSetTime) {
-            timerfd_settime(getTimerFd(), TFD_TIMER_ABSTIME, &delay, NULL);
-        }
+    }
+
+    if (toSetTime) {
+        timerfd_settime(getTimerFd(), TFD_TIMER_ABSTIME, &delay, NULL);
     }
 }
 
@@ -312,14 +459,12 @@ inline
 void LocTimerContainer::add(LocTimerDelegate& timer) {
     struct MsgTimerPush : public LocMsg {
         LocTimerContainer* mTimerContainer;
-        LocHeapNode* mTree;
         LocTimerDelegate* mTimer;
         inline MsgTimerPush(LocTimerContainer& container, LocTimerDelegate& timer) :
             LocMsg(), mTimerContainer(&container), mTimer(&timer) {}
         inline virtual void proc() const {
-            LocTimerDelegate* priorTop = mTimerContainer->getSoonestTimer();
-            mTimerContainer->push((LocRankable&)(*mTimer));
-            mTimerContainer->updateSoonestTime(priorTop);
+            mTimerContainer->push(*mTimer);
+            mTimerContainer->updateWakeTime(mTimer);
         }
     };
 
@@ -334,14 +479,10 @@ void LocTimerContainer::remove(LocTimerDelegate& timer) {
         inline MsgTimerRemove(LocTimerContainer& container, LocTimerDelegate& timer) :
             LocMsg(), mTimerContainer(&container), mTimer(&timer) {}
         inline virtual void proc() const {
-            LocTimerDelegate* priorTop = mTimerContainer->getSoonestTimer();
-
-            // update soonest timer only if mTimer is actually removed from
-            // mTimerContainer AND mTimer is not priorTop.
-            if (priorTop == ((LocHeap*)mTimerContainer)->remove((LocRankable&)*mTimer)) {
-                // if passing in NULL, we tell updateSoonestTime to update
-                // kernel with the current top timer interval.
-                mTimerContainer->updateSoonestTime(NULL);
+            // update wake up time only if mTimer is actually removed from
+            // mTimerContainer. Kernel is only updated if that moves it.
+            if (mTimerContainer->removeFromHeap(*mTimer)) {
+                mTimerContainer->updateWakeTime(NULL);
             }
             // all timers are deleted here, and only here.
             delete mTimer;
@@ -363,16 +504,18 @@ void LocTimerContainer::expire() {
             struct timespec now;
             // get time spec of now
             clock_gettime(CLOCK_BOOTTIME, &now);
-            LocTimerDelegate timerOfNow(now);
-            // pop everything in the heap that outRanks now, i.e. has time older than now
+            // kernel timer was disarmed upon this expiration
+            mTimerContainer->mArmed = false;
+            // pop everything in the heap that has time older than now, which
+            // includes timers whose slack window has opened but not closed yet,
             // and then call expire() on that timer.
-            for (LocTimerDelegate* timer = (LocTimerDelegate*)mTimerContainer->pop();
+            for (LocTimerDelegate* timer = mTimerContainer->popIfExpired(now);
                  NULL != timer;
-                 timer = mTimerContainer->popIfOutRanks(timerOfNow)) {
+                 timer = mTimerContainer->popIfExpired(now)) {
                 // the timer delegate obj will be deleted before the return of this call
                 timer->expire();
             }
-            mTimerContainer->updateSoonestTime(NULL);
+            mTimerContainer->updateWakeTime(NULL);
         }
     };
 
@@ -383,10 +526,11 @@ void LocTimerContainer::expire() {
     mMsgTask->sendMsg(new MsgTimerExpire(*this));
 }
 
-LocTimerDelegate* LocTimerContainer::popIfOutRanks(LocTimerDelegate& timer) {
+LocTimerDelegate* LocTimerContainer::popIfExpired(const struct timespec& now) {
     LocTimerDelegate* poppedNode = NULL;
-    if (mTree && !timer.outRanks(*peek())) {
-        poppedNode = (LocTimerDelegate*)(pop());
+    LocTimerDelegate* top = getSoonestTimer();
+    if (top && !isBefore(now, top->mFutureTime)) {
+        poppedNode = pop();
     }
 
     return poppedNode;
@@ -474,18 +618,46 @@ bool LocTimerPollTask::run() {
 
 /***************************LocTimerDelegate methods***************************/
 
+pthread_mutex_t LocTimerDelegate::mFreeMutex = PTHREAD_MUTEX_INITIALIZER;
+LocTimerDelegate* LocTimerDelegate::mFree = NULL;
+
 inline
 LocTimerDelegate::LocTimerDelegate(LocTimer& client,
                                    struct timespec& futureTime,
+                                   struct timespec& latestTime,
                                    LocTimerContainer* container)
     : mClient(&client),
       mLock(mClient->mLock->share()),
       mFutureTime(futureTime),
-      mContainer(container) {
+      mLatestTime(latestTime),
+      mContainer(container),
+      mHeapIndex(LOC_TIMER_NOT_IN_HEAP) {
     // adding the timer into the container
     mContainer->add(*this);
 }
 
+// deleted objs are chained through their first bytes, so the free list
+// only ever holds as many objs as there were timers ticking at once
+void* LocTimerDelegate::operator new(size_t size) {
+    void* ptr = NULL;
+    pthread_mutex_lock(&mFreeMutex);
+    if (NULL != mFree) {
+        ptr = mFree;
+        mFree = *(LocTimerDelegate**)mFree;
+    }
+    pthread_mutex_unlock(&mFreeMutex);
+    return (NULL != ptr) ? ptr : ::operator new(size);
+}
+
+void LocTimerDelegate::operator delete(void* ptr) {
+    if (NULL != ptr) {
+        pthread_mutex_lock(&mFreeMutex);
+        *(LocTimerDelegate**)ptr = mFree;
+        mFree = (LocTimerDelegate*)ptr;
+        pthread_mutex_unlock(&mFreeMutex);
+    }
+}
+
 inline
 void LocTimerDelegate::destroyLocked() {
     // client handle will likely be deleted soon after this
@@ -505,22 +677,6 @@ void LocTimerDelegate::destroyLocked() {
       // once, and we want it reach there only once.
 }
 
-int LocTimerDelegate::ranks(LocRankable& rankable) {
-    int rank = -1;
-    LocTimerDelegate* timer = (LocTimerDelegate*)(&rankable);
-    if (timer) {
-        // larger time ranks lower!!!
-        // IOW, if input obj has bigger tv_sec/tv_nsec, this obj outRanks higher
-        rank = timer->mFutureTime.tv_sec - mFutureTime.tv_sec;
-        if(0 == rank)
-        {
-            //rank against tv_nsec for msec accuracy
-            rank = (int)(timer->mFutureTime.tv_nsec - mFutureTime.tv_nsec);
-        }
-    }
-    return rank;
-}
-
 inline
 void LocTimerDelegate::expire() {
     // keeping a copy of client pointer to be safe
@@ -549,23 +705,29 @@ LocTimer::~LocTimer() {
     }
 }
 
-bool LocTimer::start(unsigned int timeOutInMs, bool wakeOnExpire) {
+static inline void addMs(struct timespec& time, uint32_t ms) {
+    time.tv_sec += ms / 1000;
+    time.tv_nsec += (ms % 1000) * 1000000;
+    if (time.tv_nsec >= 1000000000) {
+        time.tv_sec += time.tv_nsec / 1000000000;
+        time.tv_nsec %= 1000000000;
+    }
+}
+
+bool LocTimer::start(unsigned int timeOutInMs, bool wakeOnExpire, uint32_t slackInMs) {
     bool success = false;
     mLock->lock();
     if (!mTimer) {
         struct timespec futureTime;
         clock_gettime(CLOCK_BOOTTIME, &futureTime);
-        futureTime.tv_sec += timeOutInMs / 1000;
-        futureTime.tv_nsec += (timeOutInMs % 1000) * 1000000;
-        if (futureTime.tv_nsec >= 1000000000) {
-            futureTime.tv_sec += futureTime.tv_nsec / 1000000000;
-            futureTime.tv_nsec %= 1000000000;
-        }
+        addMs(futureTime, timeOutInMs);
+        struct timespec latestTime = futureTime;
+        addMs(latestTime, slackInMs);
 
         LocTimerContainer* container;
         container = LocTimerContainer::get(wakeOnExpire);
         if (NULL != container) {
-            mTimer = new LocTimerDelegate(*this, futureTime, container);
+            mTimer = new LocTimerDelegate(*this, futureTime, latestTime, container);
             // if mTimer is non 0, success should be 0; or vice versa
         }
         success = (NULL != mTimer);
@@ -653,6 +815,8 @@ void loc_timer_stop(void*&  handle)
 
 #ifdef __LOC_DEBUG__
 
+#include <LocHeap.h>
+
 double getDeltaSeconds(struct timespec from, struct timespec to) {
     return (double)to.tv_sec + (double)to.tv_nsec / 1000000000
         - from.tv_sec - (double)from.tv_nsec / 1000000000;
@@ -30,8 +30,18 @@
 #define LOG_TAG "LocSvc_MsgTask"
 
 #include <unistd.h>
+#include <limits.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <MsgTask.h>
+#include <unordered_map>
 #include <msg_q.h>
+#include <linked_list.h>
 #include <loc_log.h>
 #include <platform_lib_includes.h>
 
@@ -39,17 +49,544 @@ static void LocMsgDestroy(void* msg) {
     delete (LocMsg*)msg;
 }
 
+// LocMsg pool. Blocks are freed (on the MsgTask thread) onto a per size
+// class atomic stack. Allocating threads never pop that stack one block
+// at a time, they take it over as a whole into their thread local cache,
+// which keeps it ABA free without any lock.
+struct LocMsgBlock {
+    LocMsgBlock* mNext;
+};
+
+// header in front of each block, keeps the payload max aligned
+#define LOC_MSG_POOL_HDR_SIZE 16
+#define LOC_MSG_POOL_NO_CLASS 0xFF
+#define LOC_MSG_POOL_SLAB_BLOCKS 16
+
+static const size_t sLocMsgPoolClassSizes[] = { 64, 128, 256, 512, 1024, 2048 };
+#define LOC_MSG_POOL_CLASSES \
+    (sizeof(sLocMsgPoolClassSizes) / sizeof(sLocMsgPoolClassSizes[0]))
+
+static std::atomic<LocMsgBlock*> sLocMsgPoolFree[LOC_MSG_POOL_CLASSES];
+static std::atomic<uint64_t> sLocMsgPoolHits(0);
+static std::atomic<uint64_t> sLocMsgPoolMisses(0);
+
+static void locMsgPoolPush(uint8_t sizeClass, LocMsgBlock* first, LocMsgBlock* last) {
+    LocMsgBlock* head = sLocMsgPoolFree[sizeClass].load(std::memory_order_relaxed);
+    do {
+        last->mNext = head;
+    } while (!sLocMsgPoolFree[sizeClass].compare_exchange_weak(
+                 head, first, std::memory_order_release, std::memory_order_relaxed));
+}
+
+struct LocMsgPoolCache {
+    LocMsgBlock* mFree[LOC_MSG_POOL_CLASSES];
+    inline LocMsgPoolCache() { memset(mFree, 0, sizeof(mFree)); }
+    // hand the blocks of an exiting thread back to the shared stacks
+    ~LocMsgPoolCache() {
+        for (uint8_t i = 0; i < LOC_MSG_POOL_CLASSES; i++) {
+            if (NULL != mFree[i]) {
+                LocMsgBlock* last = mFree[i];
+                while (NULL != last->mNext) {
+                    last = last->mNext;
+                }
+                locMsgPoolPush(i, mFree[i], last);
+            }
+        }
+    }
+};
+
+static thread_local LocMsgPoolCache sLocMsgPoolCache;
+
+static void* locMsgPoolAlloc(size_t size) {
+    uint8_t sizeClass = 0;
+    while (sizeClass < LOC_MSG_POOL_CLASSES && size > sLocMsgPoolClassSizes[sizeClass]) {
+        sizeClass++;
+    }
+
+    uint8_t* block = NULL;
+    if (sizeClass >= LOC_MSG_POOL_CLASSES) {
+        sLocMsgPoolMisses.fetch_add(1, std::memory_order_relaxed);
+        block = (uint8_t*)malloc(LOC_MSG_POOL_HDR_SIZE + size);
+        sizeClass = LOC_MSG_POOL_NO_CLASS;
+    } else {
+        LocMsgBlock*& cache = sLocMsgPoolCache.mFree[sizeClass];
+        if (NULL == cache) {
+            cache = sLocMsgPoolFree[sizeClass].exchange(NULL, std::memory_order_acquire);
+        }
+        if (NULL != cache) {
+            sLocMsgPoolHits.fetch_add(1, std::memory_order_relaxed);
+            block = (uint8_t*)cache;
+            cache = cache->mNext;
+        } else {
+            sLocMsgPoolMisses.fetch_add(1, std::memory_order_relaxed);
+            // new slab; first block is handed out, the rest go to the cache
+            size_t blockSize = LOC_MSG_POOL_HDR_SIZE + sLocMsgPoolClassSizes[sizeClass];
+            block = (uint8_t*)malloc(blockSize * LOC_MSG_POOL_SLAB_BLOCKS);
+            if (NULL != block) {
+                for (int i = LOC_MSG_POOL_SLAB_BLOCKS - 1; i > 0; i--) {
+                    LocMsgBlock* b = (LocMsgBlock*)(block + blockSize * i);
+                    b->mNext = cache;
+                    cache = b;
+                }
+            }
+        }
+    }
+
+    if (NULL == block) {
+        return NULL;
+    }
+    *block = sizeClass;
+    return block + LOC_MSG_POOL_HDR_SIZE;
+}
+
+static void locMsgPoolFree(void* ptr) {
+    if (NULL != ptr) {
+        uint8_t* block = (uint8_t*)ptr - LOC_MSG_POOL_HDR_SIZE;
+        uint8_t sizeClass = *block;
+        if (LOC_MSG_POOL_NO_CLASS == sizeClass) {
+            free(block);
+        } else {
+            LocMsgBlock* b = (LocMsgBlock*)block;
+            locMsgPoolPush(sizeClass, b, b);
+        }
+    }
+}
+
+void* LocMsg::operator new(size_t size) {
+    void* ptr = locMsgPoolAlloc(size);
+    if (NULL == ptr) {
+        // like the global operator new in a build without exceptions
+        LOC_LOGE("%s: out of memory allocating %zu bytes", __func__, size);
+        abort();
+    }
+    return ptr;
+}
+
+void* LocMsg::operator new(size_t size, const std::nothrow_t&) throw() {
+    return locMsgPoolAlloc(size);
+}
+
+void LocMsg::operator delete(void* ptr) {
+    locMsgPoolFree(ptr);
+}
+
+void LocMsg::operator delete(void* ptr, const std::nothrow_t&) throw() {
+    locMsgPoolFree(ptr);
+}
+
+void LocMsg::getPoolStats(uint64_t& hits, uint64_t& misses) {
+    hits = sLocMsgPoolHits.load(std::memory_order_relaxed);
+    misses = sLocMsgPoolMisses.load(std::memory_order_relaxed);
+}
+
+class LocMsgQ {
+public:
+    inline virtual ~LocMsgQ() {}
+    // returns false if the msg could not be queued, in which case
+    // the caller still owns it
+    virtual bool send(const LocMsg* msg, LocMsgPriority priority) = 0;
+    // blocks until a msg is available; returns NULL once unblocked
+    virtual const LocMsg* receive() = 0;
+    // blocks until a msg is available, then detaches all pending msgs
+    // in one go; returns false once unblocked
+    virtual bool receiveAll() = 0;
+    // msgs detached by the last receiveAll(), oldest first; NULL when done
+    virtual const LocMsg* next() = 0;
+    virtual void unblock() = 0;
+    virtual void flush() = 0;
+};
+
+// msg_q backed queue, every send / receive goes through its mutex.
+// msg_q is a single FIFO, so priority is not honored.
+class LocLockedMsgQ : public LocMsgQ {
+    const void* mQ;
+    void* mBatch;
+public:
+    inline LocLockedMsgQ() : mQ(msg_q_init2()), mBatch(NULL) {
+        linked_list_init(&mBatch);
+    }
+    inline virtual ~LocLockedMsgQ() {
+        linked_list_destroy(&mBatch);
+        msg_q_destroy((void**)&mQ);
+    }
+    inline virtual bool send(const LocMsg* msg, LocMsgPriority /*priority*/) {
+        return eMSG_Q_SUCCESS == msg_q_snd((void*)mQ, (void*)msg, LocMsgDestroy);
+    }
+    virtual const LocMsg* receive();
+    virtual bool receiveAll();
+    inline virtual const LocMsg* next() {
+        LocMsg* msg = NULL;
+        linked_list_remove(mBatch, (void**)&msg);
+        return msg;
+    }
+    inline virtual void unblock() { msg_q_unblock((void*)mQ); }
+    inline virtual void flush() { msg_q_flush((void*)mQ); }
+};
+
+const LocMsg* LocLockedMsgQ::receive() {
+    LocMsg* msg = NULL;
+    msq_q_err_type result = msg_q_rcv((void*)mQ, (void **)&msg);
+    if (eMSG_Q_SUCCESS != result) {
+        LOC_LOGE("%s:%d] fail receiving msg: %s\n", __func__, __LINE__,
+                 loc_get_msg_q_status(result));
+        msg = NULL;
+    }
+    return msg;
+}
+
+bool LocLockedMsgQ::receiveAll() {
+    msq_q_err_type result = msg_q_rcv_all((void*)mQ, &mBatch);
+    if (eMSG_Q_SUCCESS != result) {
+        LOC_LOGE("%s:%d] fail receiving msgs: %s\n", __func__, __LINE__,
+                 loc_get_msg_q_status(result));
+        return false;
+    }
+    return true;
+}
+
+// Intrusive multi-producer / single-consumer queue (D. Vyukov), one per
+// priority lane. Producers link msgs in with a single atomic exchange on
+// the lane's mHead; the MsgTask thread is the only consumer and walks
+// mTail. The thread parks on a futex only when it finds all lanes empty,
+// and a producer issues the wake syscall only if it sees the consumer parked.
+// The default lane is always served first, but after
+// LOC_MSG_Q_BULK_STARVE_LIMIT default msgs in a row one waiting bulk msg
+// is let through.
+#define LOC_MSG_Q_BULK_STARVE_LIMIT 8
+
+class LocLockFreeMsgQ : public LocMsgQ {
+    struct Stub : public LocMsg {
+        inline virtual void proc() const {}
+    };
+    struct Lane {
+        Stub mStub;
+        std::atomic<const LocMsg*> mHead;
+        const LocMsg* mTail;
+        // current batch: the next msg to hand out, and the last msg queued
+        // when the batch was detached
+        const LocMsg* mBatchNext;
+        const LocMsg* mBatchEnd;
+        inline Lane() : mHead(&mStub), mTail(&mStub), mBatchNext(NULL), mBatchEnd(NULL) {}
+        inline bool isEmpty() { return mHead.load() == mTail; }
+        inline void push(const LocMsg* msg) {
+            msg->mNext.store(NULL, std::memory_order_relaxed);
+            const LocMsg* prev = mHead.exchange(msg);
+            prev->mNext.store(msg, std::memory_order_release);
+        }
+        // NULL if empty, or if a producer is half way through push()
+        const LocMsg* pop();
+        void detach();
+        const LocMsg* advance();
+    };
+    enum { AWAKE = 0, PARKED = 1 };
+    Lane mLanes[LOC_MSG_PRIORITY_MAX];
+    std::atomic<int> mState;
+    std::atomic<bool> mUnblocked;
+    // default lane msgs served in a row while bulk ones were waiting
+    uint32_t mDefaultRun;
+
+    inline bool isEmpty() {
+        return mLanes[LOC_MSG_PRIORITY_DEFAULT].isEmpty() &&
+               mLanes[LOC_MSG_PRIORITY_BULK].isEmpty();
+    }
+    void park();
+    inline void wake() {
+        if (PARKED == mState.load() && PARKED == mState.exchange(AWAKE)) {
+            syscall(__NR_futex, (int*)&mState, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        }
+    }
+public:
+    inline LocLockFreeMsgQ() : mState(AWAKE), mUnblocked(false), mDefaultRun(0) {}
+    inline virtual ~LocLockFreeMsgQ() {}
+    virtual bool send(const LocMsg* msg, LocMsgPriority priority);
+    virtual const LocMsg* receive();
+    virtual bool receiveAll();
+    virtual const LocMsg* next();
+    virtual void unblock();
+    virtual void flush();
+};
+
+const LocMsg* LocLockFreeMsgQ::Lane::pop() {
+    const LocMsg* tail = mTail;
+    const LocMsg* next = tail->mNext.load(std::memory_order_acquire);
+    if (&mStub == tail) {
+        if (NULL == next) {
+            return NULL;
+        }
+        mTail = tail = next;
+        next = next->mNext.load(std::memory_order_acquire);
+    }
+    if (NULL != next) {
+        mTail = next;
+        return tail;
+    }
+    if (tail != mHead.load()) {
+        return NULL;
+    }
+    // tail is the last msg, put the stub behind it so it can be detached
+    push(&mStub);
+    next = tail->mNext.load(std::memory_order_acquire);
+    if (NULL != next) {
+        mTail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+void LocLockFreeMsgQ::Lane::detach() {
+    mBatchNext = pop();
+    // nothing needs detaching here; the batch just ends at what is the
+    // newest msg now. The stub at the head means there was nothing behind
+    // the msg just taken.
+    mBatchEnd = mHead.load();
+    if (&mStub == mBatchEnd) {
+        mBatchEnd = mBatchNext;
+    }
+}
+
+const LocMsg* LocLockFreeMsgQ::Lane::advance() {
+    const LocMsg* msg = mBatchNext;
+    if (NULL != msg) {
+        mBatchNext = (msg == mBatchEnd) ? NULL : pop();
+    }
+    return msg;
+}
+
+void LocLockFreeMsgQ::park() {
+    mState.store(PARKED);
+    // re-check after announcing PARKED; a producer that pushed before
+    // this point is seen here, one that pushes after sees PARKED and wakes us
+    if (isEmpty() && !mUnblocked.load()) {
+        syscall(__NR_futex, (int*)&mState, FUTEX_WAIT_PRIVATE, PARKED, NULL, NULL, 0);
+    } else if (!isEmpty()) {
+        // possibly a producer is between its exchange and link store
+        sched_yield();
+    }
+    mState.store(AWAKE, std::memory_order_relaxed);
+}
+
+bool LocLockFreeMsgQ::send(const LocMsg* msg, LocMsgPriority priority) {
+    if (mUnblocked.load(std::memory_order_acquire)) {
+        LOC_LOGE("%s: Message queue has been unblocked.", __func__);
+        return false;
+    }
+    mLanes[LOC_MSG_PRIORITY_BULK == priority ?
+           LOC_MSG_PRIORITY_BULK : LOC_MSG_PRIORITY_DEFAULT].push(msg);
+    wake();
+    return true;
+}
+
+const LocMsg* LocLockFreeMsgQ::receive() {
+    Lane& dflt = mLanes[LOC_MSG_PRIORITY_DEFAULT];
+    Lane& bulk = mLanes[LOC_MSG_PRIORITY_BULK];
+    while (!mUnblocked.load(std::memory_order_acquire)) {
+        const LocMsg* msg = NULL;
+        if (mDefaultRun >= LOC_MSG_Q_BULK_STARVE_LIMIT) {
+            msg = bulk.pop();
+        }
+        if (NULL == msg && NULL != (msg = dflt.pop())) {
+            mDefaultRun++;
+            return msg;
+        }
+        if (NULL != msg || NULL != (msg = bulk.pop())) {
+            mDefaultRun = 0;
+            return msg;
+        }
+        park();
+    }
+    return NULL;
+}
+
+bool LocLockFreeMsgQ::receiveAll() {
+    Lane& dflt = mLanes[LOC_MSG_PRIORITY_DEFAULT];
+    Lane& bulk = mLanes[LOC_MSG_PRIORITY_BULK];
+    while (!mUnblocked.load(std::memory_order_acquire)) {
+        dflt.detach();
+        bulk.detach();
+        if (NULL != dflt.mBatchNext || NULL != bulk.mBatchNext) {
+            return true;
+        }
+        park();
+    }
+    return false;
+}
+
+const LocMsg* LocLockFreeMsgQ::next() {
+    Lane& dflt = mLanes[LOC_MSG_PRIORITY_DEFAULT];
+    Lane& bulk = mLanes[LOC_MSG_PRIORITY_BULK];
+    if (NULL != bulk.mBatchNext) {
+        // default msgs that arrived while this batch's bulk msgs are still
+        // pending get served ahead of them, in this same batch
+        if (NULL == dflt.mBatchNext) {
+            dflt.detach();
+        }
+        if (NULL == dflt.mBatchNext || mDefaultRun >= LOC_MSG_Q_BULK_STARVE_LIMIT) {
+            mDefaultRun = 0;
+            return bulk.advance();
+        }
+        mDefaultRun++;
+    }
+    return dflt.advance();
+}
+
+void LocLockFreeMsgQ::unblock() {
+    mUnblocked.store(true);
+    mState.store(AWAKE);
+    syscall(__NR_futex, (int*)&mState, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+void LocLockFreeMsgQ::flush() {
+    for (int i = 0; i < LOC_MSG_PRIORITY_MAX; i++) {
+        const LocMsg* msg;
+        while (NULL != (msg = mLanes[i].advance())) {
+            delete msg;
+        }
+        while (NULL != (msg = mLanes[i].pop())) {
+            delete msg;
+        }
+    }
+}
+
+static LocMsgQ* newMsgQ(bool lockFreeQ) {
+    if (lockFreeQ) {
+        return new LocLockFreeMsgQ();
+    }
+    return new LocLockedMsgQ();
+}
+
+// msgs whose proc() runs longer than this are logged as stalling the task
+#define LOC_MSG_STATS_STALL_USEC 100000
+// log2 usec buckets; bucket i counts [2^(i-1), 2^i) usec, the last is open ended
+#define LOC_MSG_STATS_BUCKETS 21
+
+static inline int64_t locMsgNowUsec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+struct LocMsgHistogram {
+    uint64_t mTotal;
+    int64_t mMax;
+    uint32_t mBuckets[LOC_MSG_STATS_BUCKETS];
+    inline void add(int64_t usec) {
+        int bucket = 0;
+        if (usec < 0) {
+            usec = 0;
+        }
+        for (int64_t v = usec; v > 0 && bucket < LOC_MSG_STATS_BUCKETS - 1; v >>= 1) {
+            bucket++;
+        }
+        mBuckets[bucket]++;
+        mTotal += usec;
+        if (usec > mMax) {
+            mMax = usec;
+        }
+    }
+    void dump(std::string& out, const char* label, uint32_t count) const;
+};
+
+void LocMsgHistogram::dump(std::string& out, const char* label, uint32_t count) const {
+    char line[64];
+    snprintf(line, sizeof(line), "    %s avg %" PRIu64 " max %" PRId64 " usec:",
+             label, count ? mTotal / count : 0, mMax);
+    out += line;
+    for (int i = 0; i < LOC_MSG_STATS_BUCKETS; i++) {
+        if (mBuckets[i] > 0) {
+            snprintf(line, sizeof(line), " <%" PRId64 ":%u",
+                     (int64_t)1 << i, mBuckets[i]);
+            out += line;
+        }
+    }
+    out += "\n";
+}
+
+struct LocMsgTypeStats {
+    uint32_t mCount;
+    LocMsgHistogram mWait;
+    LocMsgHistogram mRun;
+};
+
+// Updated on the MsgTask thread only, except for the depth counters which
+// senders bump. The mutex only ever contends with dump().
+class LocMsgStats {
+    const char* mName;
+    pthread_mutex_t mMutex;
+    // keyed by vtable, i.e. by the dynamic type of the msg
+    std::unordered_map<const void*, LocMsgTypeStats> mTypes;
+public:
+    std::atomic<int32_t> mDepth;
+    std::atomic<int32_t> mDepthHighWater;
+
+    inline LocMsgStats(const char* name) :
+        mName(NULL != name ? name : "MsgTask"), mDepth(0), mDepthHighWater(0) {
+        pthread_mutex_init(&mMutex, NULL);
+    }
+    inline ~LocMsgStats() { pthread_mutex_destroy(&mMutex); }
+    inline void sent() {
+        int32_t depth = mDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+        int32_t hwm = mDepthHighWater.load(std::memory_order_relaxed);
+        while (depth > hwm &&
+               !mDepthHighWater.compare_exchange_weak(hwm, depth, std::memory_order_relaxed)) {
+        }
+    }
+    void record(const void* type, int64_t waitUsec, int64_t runUsec);
+    void dump(std::string& out);
+};
+
+void LocMsgStats::record(const void* type, int64_t waitUsec, int64_t runUsec) {
+    pthread_mutex_lock(&mMutex);
+    LocMsgTypeStats& stats = mTypes[type];
+    stats.mCount++;
+    stats.mWait.add(waitUsec);
+    stats.mRun.add(runUsec);
+    pthread_mutex_unlock(&mMutex);
+}
+
+void LocMsgStats::dump(std::string& out) {
+    char line[256];
+    uint64_t hits, misses;
+    LocMsg::getPoolStats(hits, misses);
+    snprintf(line, sizeof(line), "%s: depth %d high water %d, msg pool hits %" PRIu64
+             " misses %" PRIu64 "\n", mName, mDepth.load(), mDepthHighWater.load(),
+             hits, misses);
+    out += line;
+
+    pthread_mutex_lock(&mMutex);
+    for (auto it = mTypes.begin(); it != mTypes.end(); ++it) {
+        Dl_info info = {};
+        if (0 != dladdr(it->first, &info) && NULL != info.dli_sname) {
+            snprintf(line, sizeof(line), "  %s", info.dli_sname);
+        } else if (NULL != info.dli_fname) {
+            snprintf(line, sizeof(line), "  %s+%#" PRIxPTR, info.dli_fname,
+                     (uintptr_t)it->first - (uintptr_t)info.dli_fbase);
+        } else {
+            snprintf(line, sizeof(line), "  %p", it->first);
+        }
+        out += line;
+        snprintf(line, sizeof(line), ": %u msgs\n", it->second.mCount);
+        out += line;
+        it->second.mWait.dump(out, "wait", it->second.mCount);
+        it->second.mRun.dump(out, "run ", it->second.mCount);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
+
 MsgTask::MsgTask(LocThread::tCreate tCreator,
-                 const char* threadName, bool joinable) :
-    mQ(msg_q_init2()), mThread(new LocThread()) {
+                 const char* threadName, bool joinable, bool lockFreeQ,
+                 bool batchDrain) :
+    mQ(newMsgQ(lockFreeQ)), mStats(new LocMsgStats(threadName)),
+    mThread(new LocThread()), mBatchDrain(batchDrain) {
     if (!mThread->start(tCreator, threadName, this, joinable)) {
         delete mThread;
         mThread = NULL;
     }
 }
 
-MsgTask::MsgTask(const char* threadName, bool joinable) :
-    mQ(msg_q_init2()), mThread(new LocThread()) {
+MsgTask::MsgTask(const char* threadName, bool joinable, bool lockFreeQ,
+                 bool batchDrain) :
+    mQ(newMsgQ(lockFreeQ)), mStats(new LocMsgStats(threadName)),
+    mThread(new LocThread()), mBatchDrain(batchDrain) {
     if (!mThread->start(threadName, this, joinable)) {
         delete mThread;
         mThread = NULL;
@@ -57,13 +594,14 @@ MsgTask::MsgTask(const char* threadName, bool joinable) :
 }
 
 MsgTask::~MsgTask() {
-    msg_q_flush((void*)mQ);
-    msg_q_destroy((void**)&mQ);
+    mQ->flush();
+    delete mQ;
+    delete mStats;
 }
 
 void MsgTask::destroy() {
     LocThread* thread = mThread;
-    msg_q_unblock((void*)mQ);
+    mQ->unblock();
     if (thread) {
         mThread = NULL;
         delete thread;
@@ -72,33 +610,69 @@ void MsgTask::destroy() {
     }
 }
 
-void MsgTask::sendMsg(const LocMsg* msg) const {
+void MsgTask::sendMsg(const LocMsg* msg, LocMsgPriority priority) const {
     if (msg) {
-        msg_q_snd((void*)mQ, (void*)msg, LocMsgDestroy);
+        msg->mEnqueueTime = locMsgNowUsec();
+        mStats->sent();
+        if (!mQ->send(msg, priority)) {
+            mStats->mDepth.fetch_sub(1, std::memory_order_relaxed);
+            delete msg;
+        }
     } else {
         LOC_LOGE("%s: msg is NULL", __func__);
     }
 }
 
+void MsgTask::dumpStats(std::string& out) const {
+    mStats->dump(out);
+}
+
+void MsgTask::procMsg(const LocMsg* msg) {
+    mStats->mDepth.fetch_sub(1, std::memory_order_relaxed);
+    int64_t start = locMsgNowUsec();
+
+    msg->log();
+    // there is where each individual msg handling is invoked
+    msg->proc();
+
+    int64_t end = locMsgNowUsec();
+    // the vtable pointer identifies the dynamic type without needing RTTI
+    const void* type = *(const void* const*)msg;
+    int64_t wait = start - msg->mEnqueueTime;
+    LOC_LOGV("%s: msg %p waited %" PRId64 " usec, ran %" PRId64 " usec",
+             __func__, msg, wait, end - start);
+    if (end - start > LOC_MSG_STATS_STALL_USEC) {
+        LOC_LOGW("%s: msg %p (type %p) ran %" PRId64 " usec", __func__, msg, type, end - start);
+    }
+    delete msg;
+
+    mStats->record(type, wait, end - start);
+}
+
 void MsgTask::prerun() {
     // make sure we do not run in background scheduling group
      platform_lib_abstraction_set_sched_policy(platform_lib_abstraction_gettid(), PLA_SP_FOREGROUND);
 }
 
 bool MsgTask::run() {
-    LocMsg* msg;
-    msq_q_err_type result = msg_q_rcv((void*)mQ, (void **)&msg);
-    if (eMSG_Q_SUCCESS != result) {
-        LOC_LOGE("%s:%d] fail receiving msg: %s\n", __func__, __LINE__,
-                 loc_get_msg_q_status(result));
-        return false;
+    if (mBatchDrain) {
+        if (!mQ->receiveAll()) {
+            return false;
+        }
+
+        const LocMsg* msg;
+        while (NULL != (msg = mQ->next())) {
+            procMsg(msg);
+        }
+        return true;
     }
 
-    msg->log();
-    // there is where each individual msg handling is invoked
-    msg->proc();
+    const LocMsg* msg = mQ->receive();
+    if (NULL == msg) {
+        return false;
+    }
 
-    delete msg;
+    procMsg(msg);
 
     return true;
 }
@@ -29,27 +29,90 @@
 #ifndef __MSG_TASK__
 #define __MSG_TASK__
 
+#include <stdint.h>
+#include <atomic>
+#include <new>
+#include <string>
 #include <LocThread.h>
 
+class LocLockFreeMsgQ;
+class MsgTask;
+
 struct LocMsg {
-    inline LocMsg() {}
+    inline LocMsg() : mNext(NULL), mEnqueueTime(0) {}
+    inline LocMsg(const LocMsg&) : mNext(NULL), mEnqueueTime(0) {}
+    inline LocMsg& operator=(const LocMsg&) { return *this; }
     inline virtual ~LocMsg() {}
     virtual void proc() const = 0;
     inline virtual void log() const {}
+
+    // LocMsg objs are carved out of size class slabs that are recycled
+    // instead of going back to the heap, so the steady state post / proc
+    // / delete cycle does no malloc or free. Objs larger than the
+    // biggest size class fall back to the heap.
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, const std::nothrow_t&) throw();
+    static void operator delete(void* ptr);
+    static void operator delete(void* ptr, const std::nothrow_t&) throw();
+    // hits: allocations served from recycled slab blocks
+    // misses: allocations that had to go to the heap
+    static void getPoolStats(uint64_t& hits, uint64_t& misses);
+private:
+    // intrusive link, only used while the msg sits in a lock free MsgTask queue
+    mutable std::atomic<const LocMsg*> mNext;
+    // monotonic time in usec the msg was posted with sendMsg()
+    mutable int64_t mEnqueueTime;
+    friend class LocLockFreeMsgQ;
+    friend class MsgTask;
 };
 
+// queue lanes of a MsgTask. LOC_MSG_PRIORITY_DEFAULT msgs are always
+// served ahead of LOC_MSG_PRIORITY_BULK ones, except that a bulk msg is
+// let through after a run of default ones so the bulk lane cannot starve.
+// Relative order is only kept among msgs of the same lane.
+typedef enum {
+    LOC_MSG_PRIORITY_DEFAULT = 0,
+    LOC_MSG_PRIORITY_BULK,
+    LOC_MSG_PRIORITY_MAX
+} LocMsgPriority;
+
+// opaque class to provide queue implementation.
+class LocMsgQ;
+// opaque class to collect queue latency / depth statistics.
+class LocMsgStats;
+
 class MsgTask : public LocRunnable {
-    const void* mQ;
+    LocMsgQ* mQ;
+    LocMsgStats* mStats;
     LocThread* mThread;
+    const bool mBatchDrain;
     friend class LocThreadDelegate;
+    void procMsg(const LocMsg* msg);
 protected:
     virtual ~MsgTask();
 public:
-    MsgTask(LocThread::tCreate tCreator, const char* threadName = NULL, bool joinable = true);
-    MsgTask(const char* threadName = NULL, bool joinable = true);
+    // lockFreeQ selects the queue msgs are posted through:
+    // false - mutex / condvar protected msg_q;
+    // true  - lock free multi-producer / single-consumer queue of
+    //         intrusively linked msgs. Senders never take a lock, and
+    //         only wake the thread (futex) if it is parked idle.
+    // batchDrain: each wakeup takes all pending msgs off the queue at
+    //         once and proc()s them in order.
+    MsgTask(LocThread::tCreate tCreator, const char* threadName = NULL,
+            bool joinable = true, bool lockFreeQ = false, bool batchDrain = false);
+    MsgTask(const char* threadName = NULL, bool joinable = true,
+            bool lockFreeQ = false, bool batchDrain = false);
     // this obj will be deleted once thread is deleted
     void destroy();
-    void sendMsg(const LocMsg* msg) const;
+    // priority lanes are only implemented by the lockFreeQ queue
+    void sendMsg(const LocMsg* msg,
+                 LocMsgPriority priority = LOC_MSG_PRIORITY_DEFAULT) const;
+    // Appends a text report of this MsgTask's queue statistics: high water
+    // mark of the queue depth, and for each msg type (dynamic type, named
+    // by its vtable symbol or library offset), how long its msgs waited
+    // between sendMsg() and proc(), and how long proc() ran, as log2 usec
+    // histograms. Callable from any thread.
+    void dumpStats(std::string& out) const;
     // Overrides of LocRunnable methods
     // This method will be repeated called until it returns false; or
     // until thread is stopped.
@@ -0,0 +1,456 @@
+/* Copyright (c) 2017, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Benchmarks of the gps utils primitives that sit on the hot paths of the
+// HAL: msg_q, MsgTask, LocTimer and the NMEA generator.
+//
+// Each result is printed as one JSON obj per line, e.g.
+//   {"bench":"msg_task","variant":"lockfree","producers":4,"ops":400000,
+//    "ns_per_op":123.4,"p50_us":12,"p99_us":80}
+// so runs can be diffed or fed to a regression check. Any argument given is
+// a substring filter on the bench name, e.g. "loc_bench timer_heap".
+//
+// Host build (from gps/utils, with stubs for the android headers as needed):
+//     g++ -O2 -std=c++11 -I. -Iplatform_lib_abstractions/loc_pla/include
+//         -o loc_bench loc_bench.cpp MsgTask.cpp LocThread.cpp LocTimer.cpp
+//         loc_nmea.cpp loc_log.cpp loc_target.cpp loc_cfg.cpp
+//         loc_misc_utils.cpp msg_q.c linked_list.c -lpthread -ldl
+// or "make loc_bench" with the autotools build.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <msg_q.h>
+#include <MsgTask.h>
+#include <LocTimer.h>
+#include <loc_nmea.h>
+
+static const char* sFilter = NULL;
+
+static inline int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static bool isSelected(const char* bench) {
+    return (NULL == sFilter || NULL != strstr(bench, sFilter));
+}
+
+// latencies in ns, reported as percentiles in us; empty if not measured
+static void report(const char* bench, const char* variant, int param,
+                   const char* paramName, uint64_t ops, int64_t elapsedNs,
+                   std::vector<int64_t>* latencies = NULL) {
+    printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"%s\":%d,\"ops\":%llu,"
+           "\"ns_per_op\":%.1f",
+           bench, variant, paramName, param, (unsigned long long)ops,
+           ops ? (double)elapsedNs / ops : 0.0);
+    if (NULL != latencies && !latencies->empty()) {
+        std::sort(latencies->begin(), latencies->end());
+        size_t size = latencies->size();
+        printf(",\"p50_us\":%lld,\"p99_us\":%lld,\"max_us\":%lld",
+               (long long)((*latencies)[size / 2] / 1000),
+               (long long)((*latencies)[size * 99 / 100] / 1000),
+               (long long)((*latencies)[size - 1] / 1000));
+    }
+    printf("}\n");
+    fflush(stdout);
+}
+
+/******************************** msg_q *************************************/
+
+#define BENCH_Q_MSGS_PER_PRODUCER 50000
+
+struct BenchQMsg {
+    int64_t mSent;
+};
+
+struct BenchQProducer {
+    void* mQ;
+    int mCount;
+};
+
+static void* benchQProduce(void* arg) {
+    BenchQProducer* producer = (BenchQProducer*)arg;
+    for (int i = 0; i < producer->mCount; i++) {
+        BenchQMsg* msg = (BenchQMsg*)malloc(sizeof(BenchQMsg));
+        msg->mSent = nowNs();
+        msg_q_snd(producer->mQ, msg, free);
+    }
+    return NULL;
+}
+
+static void benchMsgQ(int producers) {
+    void* q = NULL;
+    if (eMSG_Q_SUCCESS != msg_q_init(&q)) {
+        return;
+    }
+    int total = producers * BENCH_Q_MSGS_PER_PRODUCER;
+    std::vector<int64_t> latencies;
+    latencies.reserve(total);
+    std::vector<pthread_t> threads(producers);
+    BenchQProducer producer = { q, BENCH_Q_MSGS_PER_PRODUCER };
+
+    int64_t start = nowNs();
+    for (int i = 0; i < producers; i++) {
+        pthread_create(&threads[i], NULL, benchQProduce, &producer);
+    }
+    for (int i = 0; i < total; i++) {
+        void* msg = NULL;
+        if (eMSG_Q_SUCCESS != msg_q_rcv(q, &msg)) {
+            break;
+        }
+        latencies.push_back(nowNs() - ((BenchQMsg*)msg)->mSent);
+        free(msg);
+    }
+    int64_t elapsed = nowNs() - start;
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    msg_q_destroy(&q);
+
+    report("msg_q", "locked", producers, "producers", latencies.size(), elapsed, &latencies);
+}
+
+/******************************** MsgTask ***********************************/
+
+static std::atomic<int> sMsgTaskDone;
+static std::vector<int64_t> sMsgTaskLatencies;
+
+struct BenchMsg : public LocMsg {
+    const int64_t mSent;
+    inline BenchMsg() : LocMsg(), mSent(nowNs()) {}
+    // only ever run on the one MsgTask thread
+    inline virtual void proc() const {
+        sMsgTaskLatencies.push_back(nowNs() - mSent);
+        sMsgTaskDone++;
+    }
+};
+
+struct BenchTaskProducer {
+    const MsgTask* mTask;
+    int mCount;
+};
+
+static void* benchTaskProduce(void* arg) {
+    BenchTaskProducer* producer = (BenchTaskProducer*)arg;
+    for (int i = 0; i < producer->mCount; i++) {
+        producer->mTask->sendMsg(new BenchMsg());
+    }
+    return NULL;
+}
+
+static void benchMsgTask(int producers, bool lockFreeQ, bool batchDrain) {
+    int total = producers * BENCH_Q_MSGS_PER_PRODUCER;
+    sMsgTaskDone = 0;
+    sMsgTaskLatencies.clear();
+    sMsgTaskLatencies.reserve(total);
+    MsgTask* task = new MsgTask("LocBenchMsgTask", false, lockFreeQ, batchDrain);
+    std::vector<pthread_t> threads(producers);
+    BenchTaskProducer producer = { task, BENCH_Q_MSGS_PER_PRODUCER };
+
+    int64_t start = nowNs();
+    for (int i = 0; i < producers; i++) {
+        pthread_create(&threads[i], NULL, benchTaskProduce, &producer);
+    }
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    while (sMsgTaskDone < total) {
+        sched_yield();
+    }
+    int64_t elapsed = nowNs() - start;
+    task->destroy();
+
+    const char* variant = lockFreeQ ? (batchDrain ? "lockfree_batch" : "lockfree") :
+                                      (batchDrain ? "locked_batch" : "locked");
+    report("msg_task", variant, producers, "producers", total, elapsed,
+           &sMsgTaskLatencies);
+}
+
+/******************************** LocTimer **********************************/
+
+struct BenchTimer : public LocTimer {
+    static std::atomic<uint32_t> sExpired;
+    inline virtual void timeOutCallback() { sExpired++; }
+};
+std::atomic<uint32_t> BenchTimer::sExpired(0);
+
+// The timer heap is only touched on the timer MsgTask, so a 0 ms timer
+// started after a batch of start() / stop() calls expires only once all of
+// them have been applied to the heap.
+static void waitTimerMsgTask() {
+    BenchTimer fence;
+    uint32_t expired = BenchTimer::sExpired;
+    fence.start(0, false);
+    while (BenchTimer::sExpired == expired) {
+        sched_yield();
+    }
+}
+
+// push / remove / expire of the 4-ary timer heap, through the LocTimer API
+// and including the hop to the timer MsgTask. Timers are started in a
+// shuffled order of distinct timeouts, every third one is stopped, and the
+// rest are restarted with a 0 ms timeout and expired.
+static void benchLocTimerHeap(int timers) {
+    std::vector<BenchTimer> clients(timers);
+    std::vector<int> order(timers);
+    for (int i = 0; i < timers; i++) {
+        order[i] = i;
+    }
+    std::mt19937 random(timers);
+    std::shuffle(order.begin(), order.end(), random);
+
+    // repeat small sizes enough to be measurable
+    int rounds = std::max(1, 20000 / timers);
+    int64_t pushNs = 0, removeNs = 0, expireNs = 0;
+    uint64_t removed = 0, expired = 0;
+    for (int r = 0; r < rounds; r++) {
+        int64_t start = nowNs();
+        for (int i = 0; i < timers; i++) {
+            clients[order[i]].start(600000 + order[i], false);
+        }
+        waitTimerMsgTask();
+        pushNs += nowNs() - start;
+
+        start = nowNs();
+        for (int i = 0; i < timers; i += 3) {
+            clients[order[i]].stop();
+            removed++;
+        }
+        waitTimerMsgTask();
+        removeNs += nowNs() - start;
+
+        for (int i = 0; i < timers; i++) {
+            clients[i].stop();
+        }
+        waitTimerMsgTask();
+
+        uint32_t target = BenchTimer::sExpired + timers;
+        start = nowNs();
+        for (int i = 0; i < timers; i++) {
+            clients[order[i]].start(0, false);
+        }
+        while (BenchTimer::sExpired < target) {
+            sched_yield();
+        }
+        expireNs += nowNs() - start;
+        expired += timers;
+    }
+
+    report("loc_timer_heap", "push", timers, "timers", (uint64_t)rounds * timers, pushNs);
+    report("loc_timer_heap", "remove", timers, "timers", removed, removeNs);
+    report("loc_timer_heap", "start_expire", timers, "timers", expired, expireNs);
+}
+
+// start / stop cycles on a set of concurrently ticking timers. The timeouts
+// are long enough that none expires during the run.
+static void benchLocTimer(int timers) {
+    std::vector<BenchTimer> clients(timers);
+    int rounds = std::max(1, 20000 / timers);
+
+    int64_t start = nowNs();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < timers; i++) {
+            clients[i].start(60000 + (i * 7919) % 60000, false);
+        }
+        for (int i = 0; i < timers; i++) {
+            clients[i].stop();
+        }
+    }
+    int64_t elapsed = nowNs() - start;
+
+    report("loc_timer", "start_stop", timers, "timers", (uint64_t)rounds * timers, elapsed);
+}
+
+/********************************* NMEA *************************************/
+
+static void benchNmea(int svs) {
+    static const GnssSvType types[] = {
+        GNSS_SV_TYPE_GPS, GNSS_SV_TYPE_GLONASS, GNSS_SV_TYPE_GALILEO,
+        GNSS_SV_TYPE_BEIDOU, GNSS_SV_TYPE_QZSS
+    };
+    static const uint16_t firstSvId[] = { 1, 65, 301, 201, 193 };
+
+    GnssSvNotification svNotify;
+    memset(&svNotify, 0, sizeof(svNotify));
+    svNotify.size = sizeof(svNotify);
+    svNotify.count = std::min(svs, (int)GNSS_SV_MAX);
+    for (size_t i = 0; i < svNotify.count; i++) {
+        GnssSv& sv = svNotify.gnssSvs[i];
+        sv.size = sizeof(GnssSv);
+        sv.type = types[i % 5];
+        sv.svId = firstSvId[i % 5] + i / 5;
+        sv.cN0Dbhz = 20.0f + i % 25;
+        sv.elevation = 5.0f + (i * 7) % 85;
+        sv.azimuth = (float)((i * 37) % 360);
+        sv.gnssSvOptionsMask = GNSS_SV_OPTIONS_HAS_EPHEMER_BIT |
+                ((i % 2) ? GNSS_SV_OPTIONS_USED_IN_FIX_BIT : 0);
+    }
+
+    UlpLocation location;
+    memset(&location, 0, sizeof(location));
+    location.size = sizeof(location);
+    location.gpsLocation.flags = LOC_GPS_LOCATION_HAS_LAT_LONG |
+            LOC_GPS_LOCATION_HAS_ALTITUDE | LOC_GPS_LOCATION_HAS_SPEED |
+            LOC_GPS_LOCATION_HAS_BEARING | LOC_GPS_LOCATION_HAS_ACCURACY;
+    location.gpsLocation.latitude = 37.4219999;
+    location.gpsLocation.longitude = -122.0840575;
+    location.gpsLocation.altitude = 12.5;
+    location.gpsLocation.speed = 13.4f;
+    location.gpsLocation.bearing = 271.3f;
+    location.gpsLocation.accuracy = 3.9f;
+    location.gpsLocation.timestamp = 1500000000000LL;
+    location.tech_mask = LOC_POS_TECH_MASK_SATELLITE;
+
+    GpsLocationExtended locationExtended;
+    memset(&locationExtended, 0, sizeof(locationExtended));
+    locationExtended.size = sizeof(locationExtended);
+    locationExtended.flags = GPS_LOCATION_EXTENDED_HAS_DOP |
+            GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL |
+            GPS_LOCATION_EXTENDED_HAS_MAG_DEV |
+            GPS_LOCATION_EXTENDED_HAS_GNSS_SV_USED_DATA |
+            GPS_LOCATION_EXTENDED_HAS_POS_TECH_MASK;
+    locationExtended.altitudeMeanSeaLevel = 42.1f;
+    locationExtended.pdop = 1.8f;
+    locationExtended.hdop = 0.9f;
+    locationExtended.vdop = 1.5f;
+    locationExtended.magneticDeviation = 13.2f;
+    locationExtended.tech_mask = LOC_POS_TECH_MASK_SATELLITE;
+    for (size_t i = 1; i < svNotify.count; i += 2) {
+        const GnssSv& sv = svNotify.gnssSvs[i];
+        switch (sv.type) {
+        case GNSS_SV_TYPE_GPS:
+            locationExtended.gnss_sv_used_ids.gps_sv_used_ids_mask |= 1ULL << (sv.svId - 1);
+            break;
+        case GNSS_SV_TYPE_GLONASS:
+            locationExtended.gnss_sv_used_ids.glo_sv_used_ids_mask |= 1ULL << (sv.svId - 65);
+            break;
+        case GNSS_SV_TYPE_GALILEO:
+            locationExtended.gnss_sv_used_ids.gal_sv_used_ids_mask |= 1ULL << (sv.svId - 301);
+            break;
+        case GNSS_SV_TYPE_BEIDOU:
+            locationExtended.gnss_sv_used_ids.bds_sv_used_ids_mask |= 1ULL << (sv.svId - 201);
+            break;
+        case GNSS_SV_TYPE_QZSS:
+            locationExtended.gnss_sv_used_ids.qzss_sv_used_ids_mask |= 1ULL << (sv.svId - 193);
+            break;
+        default:
+            break;
+        }
+    }
+
+    const int epochs = 20000;
+    std::vector<std::string> nmeaArraystr;
+    int64_t svNs = 0, posNs = 0;
+    for (int i = 0; i < epochs; i++) {
+        nmeaArraystr.clear();
+        int64_t start = nowNs();
+        loc_nmea_generate_sv(svNotify, nmeaArraystr);
+        svNs += nowNs() - start;
+
+        nmeaArraystr.clear();
+        start = nowNs();
+        loc_nmea_generate_pos(location, locationExtended, true, nmeaArraystr);
+        posNs += nowNs() - start;
+        location.gpsLocation.timestamp += 1000;
+    }
+
+    report("nmea", "generate_sv", svs, "svs", epochs, svNs);
+    report("nmea", "generate_pos", svs, "svs", epochs, posNs);
+
+    // as GnssAdapter does it, into the buffer of a reused context
+    NmeaContext* nmeaContext = new NmeaContext();
+    svNs = 0;
+    posNs = 0;
+    for (int i = 0; i < epochs; i++) {
+        int64_t start = nowNs();
+        nmeaContext->generateSv(svNotify);
+        svNs += nowNs() - start;
+
+        start = nowNs();
+        nmeaContext->generatePos(location, locationExtended, true);
+        posNs += nowNs() - start;
+        location.gpsLocation.timestamp += 1000;
+    }
+    delete nmeaContext;
+
+    report("nmea", "generate_sv_buffer", svs, "svs", epochs, svNs);
+    report("nmea", "generate_pos_buffer", svs, "svs", epochs, posNs);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        sFilter = argv[1];
+    }
+
+    static const int producers[] = { 1, 2, 4, 8 };
+    for (size_t i = 0; i < sizeof(producers) / sizeof(producers[0]); i++) {
+        if (isSelected("msg_q")) {
+            benchMsgQ(producers[i]);
+        }
+        if (isSelected("msg_task")) {
+            benchMsgTask(producers[i], false, false);
+            benchMsgTask(producers[i], true, false);
+            benchMsgTask(producers[i], true, true);
+        }
+    }
+
+    static const int sizes[] = { 10, 100, 1000, 10000 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (isSelected("loc_timer_heap")) {
+            benchLocTimerHeap(sizes[i]);
+        }
+    }
+
+    static const int timers[] = { 1, 10, 100 };
+    for (size_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+        if (isSelected("loc_timer")) {
+            benchLocTimer(timers[i]);
+        }
+    }
+
+    static const int svs[] = { 12, 40 };
+    for (size_t i = 0; i < sizeof(svs) / sizeof(svs[0]); i++) {
+        if (isSelected("nmea")) {
+            benchNmea(svs[i]);
+        }
+    }
+
+    return 0;
+}
@@ -37,6 +37,9 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <time.h>
+#include <sys/stat.h>
+#include <string>
+#include <unordered_map>
 #include <loc_cfg.h>
 #include <platform_lib_includes.h>
 #include <loc_misc_utils.h>
@@ -71,6 +74,31 @@ typedef struct loc_param_v_type
     double param_double_value;
 }loc_param_v_type;
 
+/* Parsed value of a config item, as kept in the config store */
+typedef struct loc_conf_value_type
+{
+    std::string param_str_value;
+    int param_int_value;
+    double param_double_value;
+}loc_conf_value_type;
+
+typedef std::unordered_map<std::string, loc_conf_value_type> loc_conf_items_type;
+
+/* A config file parsed into a hashed name -> value store. It is reparsed
+   only if the size or mtime of the file changes. */
+typedef struct loc_conf_file_type
+{
+    bool parsed;
+    time_t mtime;
+    off_t size;
+    loc_conf_items_type items;
+}loc_conf_file_type;
+
+/* Config files read so far, keyed by file name. Shared by all callers of
+   loc_read_conf() and never freed. Guarded by loc_conf_mutex. */
+static pthread_mutex_t loc_conf_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::unordered_map<std::string, loc_conf_file_type>* loc_conf_files = NULL;
+
 /*===========================================================================
 FUNCTION loc_set_config_entry
 
@@ -158,6 +186,64 @@ int loc_set_config_entry(const loc_param_s_type* config_entry, loc_param_v_type*
     return ret;
 }
 
+/*===========================================================================
+FUNCTION loc_parse_conf_item
+
+DESCRIPTION
+   Takes a line of configuration item and separates it into the parameter
+   name and value, parsing the value as a number as well.
+
+PARAMETERS:
+   input_buf : buffer contanis config item, tokenized in place
+   config_value: parsed item, pointing into input_buf
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   true if the line is a "name = value" item
+
+SIDE EFFECTS
+   N/A
+===========================================================================*/
+static bool loc_parse_conf_item(char* input_buf, loc_param_v_type* config_value)
+{
+    bool ret = false;
+    char *lasts;
+    memset(config_value, 0, sizeof(*config_value));
+
+    /* Separate variable and value */
+    config_value->param_name = strtok_r(input_buf, "=", &lasts);
+    /* skip lines that do not contain "=" */
+    if (config_value->param_name) {
+        config_value->param_str_value = strtok_r(NULL, "=", &lasts);
+
+        /* skip lines that do not contain two operands */
+        if (config_value->param_str_value) {
+            /* Trim leading and trailing spaces */
+            loc_util_trim_space(config_value->param_name);
+            loc_util_trim_space(config_value->param_str_value);
+
+            /* Parse numerical value */
+            if ((strlen(config_value->param_str_value) >=3) &&
+                (config_value->param_str_value[0] == '0') &&
+                (tolower(config_value->param_str_value[1]) == 'x'))
+            {
+                /* hex */
+                config_value->param_int_value = (int) strtol(&config_value->param_str_value[2],
+                                                             (char**) NULL, 16);
+            }
+            else {
+                config_value->param_double_value = (double) atof(config_value->param_str_value); /* float */
+                config_value->param_int_value = atoi(config_value->param_str_value); /* dec */
+            }
+            ret = true;
+        }
+    }
+
+    return ret;
+}
+
 /*===========================================================================
 FUNCTION loc_fill_conf_item
 
@@ -186,41 +272,13 @@ int loc_fill_conf_item(char* input_buf,
     int ret = 0;
 
     if (input_buf && config_table) {
-        char *lasts;
         loc_param_v_type config_value;
-        memset(&config_value, 0, sizeof(config_value));
-
-        /* Separate variable and value */
-        config_value.param_name = strtok_r(input_buf, "=", &lasts);
-        /* skip lines that do not contain "=" */
-        if (config_value.param_name) {
-            config_value.param_str_value = strtok_r(NULL, "=", &lasts);
-
-            /* skip lines that do not contain two operands */
-            if (config_value.param_str_value) {
-                /* Trim leading and trailing spaces */
-                loc_util_trim_space(config_value.param_name);
-                loc_util_trim_space(config_value.param_str_value);
-
-                /* Parse numerical value */
-                if ((strlen(config_value.param_str_value) >=3) &&
-                    (config_value.param_str_value[0] == '0') &&
-                    (tolower(config_value.param_str_value[1]) == 'x'))
-                {
-                    /* hex */
-                    config_value.param_int_value = (int) strtol(&config_value.param_str_value[2],
-                                                                (char**) NULL, 16);
-                }
-                else {
-                    config_value.param_double_value = (double) atof(config_value.param_str_value); /* float */
-                    config_value.param_int_value = atoi(config_value.param_str_value); /* dec */
-                }
 
-                for(uint32_t i = 0; NULL != config_table && i < table_length; i++)
-                {
-                    if(!loc_set_config_entry(&config_table[i], &config_value)) {
-                        ret += 1;
-                    }
+        if (loc_parse_conf_item(input_buf, &config_value)) {
+            for(uint32_t i = 0; NULL != config_table && i < table_length; i++)
+            {
+                if(!loc_set_config_entry(&config_table[i], &config_value)) {
+                    ret += 1;
                 }
             }
         }
@@ -355,6 +413,114 @@ int loc_update_conf(const char* conf_data, int32_t length,
     return ret;
 }
 
+/*===========================================================================
+FUNCTION loc_get_conf_items_locked
+
+DESCRIPTION
+   Looks up the parsed items of the specified configuration file, parsing
+   the file if it has not been, or if it has changed since. Items appearing
+   more than once in the file take the last value. loc_conf_mutex must be
+   held for as long as the returned items are used.
+
+PARAMETERS:
+   conf_file_name: configuration file to read
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   parsed items of the file; NULL if the file can not be read
+
+SIDE EFFECTS
+   N/A
+===========================================================================*/
+static const loc_conf_items_type* loc_get_conf_items_locked(const char* conf_file_name)
+{
+    struct stat conf_stat;
+    if (stat(conf_file_name, &conf_stat) != 0) {
+        return NULL;
+    }
+
+    if (NULL == loc_conf_files) {
+        loc_conf_files = new std::unordered_map<std::string, loc_conf_file_type>();
+    }
+    loc_conf_file_type& conf_file = (*loc_conf_files)[conf_file_name];
+    if (conf_file.parsed &&
+        conf_file.mtime == conf_stat.st_mtime && conf_file.size == conf_stat.st_size) {
+        return &conf_file.items;
+    }
+
+    FILE *conf_fp = fopen(conf_file_name, "r");
+    if (NULL == conf_fp) {
+        loc_conf_files->erase(conf_file_name);
+        return NULL;
+    }
+
+    char input_buf[LOC_MAX_PARAM_LINE];  /* declare a char array */
+    loc_param_v_type config_value;
+    conf_file.items.clear();
+    while (fgets(input_buf, LOC_MAX_PARAM_LINE, conf_fp)) {
+        if (loc_parse_conf_item(input_buf, &config_value)) {
+            loc_conf_value_type& item = conf_file.items[config_value.param_name];
+            item.param_str_value = config_value.param_str_value;
+            item.param_int_value = config_value.param_int_value;
+            item.param_double_value = config_value.param_double_value;
+        }
+    }
+    fclose(conf_fp);
+
+    conf_file.parsed = true;
+    conf_file.mtime = conf_stat.st_mtime;
+    conf_file.size = conf_stat.st_size;
+    LOC_LOGD("%s: parsed %s, %zu items", __FUNCTION__, conf_file_name, conf_file.items.size());
+
+    return &conf_file.items;
+}
+
+/*===========================================================================
+FUNCTION loc_fill_conf_table
+
+DESCRIPTION
+   Sets the values of the passed in configuration table from the parsed
+   items of a configuration file, with one hash lookup per table entry.
+
+PARAMETERS:
+   conf_items: parsed items of a configuration file
+   config_table: table definition of strings to places to store information
+   table_length: length of the configuration table
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   None
+
+SIDE EFFECTS
+   N/A
+===========================================================================*/
+static void loc_fill_conf_table(const loc_conf_items_type& conf_items,
+                                const loc_param_s_type* config_table, uint32_t table_length)
+{
+    for(uint32_t i = 0; i < table_length; i++)
+    {
+        /* Clear validity bit, set again if the item is found */
+        if(NULL != config_table[i].param_set)
+        {
+            *(config_table[i].param_set) = 0;
+        }
+
+        loc_conf_items_type::const_iterator it = conf_items.find(config_table[i].param_name);
+        if (it != conf_items.end()) {
+            loc_param_v_type config_value;
+            config_value.param_name = (char*)it->first.c_str();
+            config_value.param_str_value = (char*)it->second.param_str_value.c_str();
+            config_value.param_int_value = it->second.param_int_value;
+            config_value.param_double_value = it->second.param_double_value;
+            loc_set_config_entry(&config_table[i], &config_value);
+        }
+    }
+}
+
 /*===========================================================================
 FUNCTION loc_read_conf
 
@@ -362,6 +528,8 @@ DESCRIPTION
    Reads the specified configuration file and sets defined values based on
    the passed in configuration table. This table maps strings to values to
    set along with the type of each of these values.
+   Each file is parsed only once and shared across callers, see
+   loc_get_conf_items_locked().
 
 PARAMETERS:
    conf_file_name: configuration file to read
@@ -380,21 +548,17 @@ SIDE EFFECTS
 void loc_read_conf(const char* conf_file_name, const loc_param_s_type* config_table,
                    uint32_t table_length)
 {
-    FILE *conf_fp = NULL;
-    char *lasts;
-    loc_param_v_type config_value;
-    uint32_t i;
-
-    if((conf_fp = fopen(conf_file_name, "r")) != NULL)
+    pthread_mutex_lock(&loc_conf_mutex);
+    const loc_conf_items_type* conf_items = loc_get_conf_items_locked(conf_file_name);
+    if(NULL != conf_items)
     {
         LOC_LOGD("%s: using %s", __FUNCTION__, conf_file_name);
         if(table_length && config_table) {
-            loc_read_conf_r(conf_fp, config_table, table_length);
-            rewind(conf_fp);
+            loc_fill_conf_table(*conf_items, config_table, table_length);
         }
-        loc_read_conf_r(conf_fp, loc_param_table, loc_param_num);
-        fclose(conf_fp);
+        loc_fill_conf_table(*conf_items, loc_param_table, loc_param_num);
     }
+    pthread_mutex_unlock(&loc_conf_mutex);
     /* Initialize logging mechanism with parsed data */
     loc_logger_init(DEBUG_LEVEL, TIMESTAMP);
 }
@@ -31,6 +31,7 @@
 #define LOG_TAG "LocSvc_nmea"
 #include <loc_nmea.h>
 #include <math.h>
+#include <pthread.h>
 #include <platform_lib_includes.h>
 
 #define GLONASS_SV_ID_OFFSET 64
@@ -54,25 +55,6 @@ typedef struct loc_nmea_sv_meta_s
     uint32_t systemId;
 } loc_nmea_sv_meta;
 
-typedef struct loc_sv_cache_info_s
-{
-    uint32_t gps_used_mask;
-    uint32_t glo_used_mask;
-    uint32_t gal_used_mask;
-    uint32_t qzss_used_mask;
-    uint32_t bds_used_mask;
-    uint32_t gps_count;
-    uint32_t glo_count;
-    uint32_t gal_count;
-    uint32_t qzss_count;
-    uint32_t bds_count;
-    float hdop;
-    float pdop;
-    float vdop;
-} loc_sv_cache_info;
-
-static loc_sv_cache_info sv_cache_info;
-
 /*===========================================================================
 FUNCTION    loc_nmea_sv_meta_init
 
@@ -89,7 +71,8 @@ SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-static loc_nmea_sv_meta* loc_nmea_sv_meta_init(loc_nmea_sv_meta& sv_meta,
+static loc_nmea_sv_meta* loc_nmea_sv_meta_init(const loc_sv_cache_info& sv_cache_info,
+                                               loc_nmea_sv_meta& sv_meta,
                                                GnssSvType svType,
                                                bool needCombine)
 {
@@ -159,41 +142,213 @@ static loc_nmea_sv_meta* loc_nmea_sv_meta_init(loc_nmea_sv_meta& sv_meta,
 }
 
 /*===========================================================================
-FUNCTION    loc_nmea_put_checksum
+CLASS    LocNmeaWriter
 
 DESCRIPTION
-   Generate NMEA sentences generated based on position report
+   Writes the fields of one NMEA sentence into its buffer, emitting numbers
+   digit by digit from integers, and keeping the XOR checksum up to date as
+   each character is written. The output is the same as that of the printf
+   formats noted on each method. Fixed point values that fall (within the
+   error of double arithmetic) on a rounding tie, or are out of range, are
+   left to snprintf, so that rounding stays identical.
+
+===========================================================================*/
+static const uint64_t sPow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL
+};
+#define NMEA_MAX_DECIMALS ((int)(sizeof(sPow10) / sizeof(sPow10[0])) - 1)
+
+class LocNmeaWriter {
+    char* mSentence;
+    char* mMarker;
+    char* mEnd;
+    uint8_t mChecksum;
+    bool mOverflow;
+
+    // writes digits of value, at least minDigits of them
+    inline void putDigits(uint64_t value, int minDigits) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count++] = '0' + (value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (count < minDigits && count < (int)sizeof(digits)) {
+            digits[count++] = '0';
+        }
+        while (count > 0) {
+            putChar(digits[--count]);
+        }
+    }
+    static inline int countDigits(uint64_t value) {
+        int count = 1;
+        while (value >= 10) {
+            value /= 10;
+            count++;
+        }
+        return count;
+    }
+public:
+    // starts the sentence with '$', which is not part of the checksum
+    inline LocNmeaWriter(char* sentence, int bufSize) :
+        mSentence(sentence), mMarker(sentence), mEnd(sentence + bufSize),
+        mChecksum(0), mOverflow(bufSize <= 0) {
+        if (!mOverflow) {
+            *mMarker++ = '$';
+        }
+    }
+    inline void putChar(char c) {
+        // always leave room for the terminating NUL
+        if (mMarker + 1 < mEnd) {
+            *mMarker++ = c;
+            mChecksum ^= (uint8_t)c;
+        } else {
+            mOverflow = true;
+        }
+    }
+    // "%s"
+    inline void putStr(const char* str) {
+        while ('\0' != *str) {
+            putChar(*str++);
+        }
+    }
+    // "%0<width>d"
+    inline void putInt(int value, int width = 0) {
+        uint64_t magnitude = (value < 0) ? -(int64_t)value : value;
+        if (value < 0) {
+            putChar('-');
+            width--;
+        }
+        putDigits(magnitude, width);
+    }
+    // "%0<width>.<decimals>f"
+    void putFixed(double value, int decimals, int width = 0) {
+        double scaled = fabs(value) * (decimals <= NMEA_MAX_DECIMALS ? sPow10[decimals] : 0);
+        double integral = floor(scaled);
+        double fraction = scaled - integral;
+        // a product within its rounding error of a tie could round either
+        // way, so is left to snprintf, as are NaN, inf and huge values
+        if (decimals > NMEA_MAX_DECIMALS || !(scaled < 1e15) ||
+            fabs(fraction - 0.5) < 1e-9 + scaled * 4e-16) {
+            char field[NMEA_SENTENCE_MAX_LENGTH];
+            snprintf(field, sizeof(field), "%0*.*f", width, decimals, value);
+            putStr(field);
+            return;
+        }
+
+        uint64_t rounded = (uint64_t)integral + (fraction > 0.5 ? 1 : 0);
+        uint64_t integer = rounded / sPow10[decimals];
+        int length = countDigits(integer) + (decimals > 0 ? decimals + 1 : 0);
+        if (signbit(value)) {
+            putChar('-');
+            length++;
+        }
+        while (length < width) {
+            putChar('0');
+            length++;
+        }
+        putDigits(integer, 0);
+        if (decimals > 0) {
+            putChar('.');
+            putDigits(rounded % sPow10[decimals], decimals);
+        }
+    }
+    // appends "*CC\r\n" and the terminating NUL
+    // returns the total length of the sentence; -1 if it does not fit
+    int finish() {
+        static const char hex[] = "0123456789ABCDEF";
+        uint8_t checksum = mChecksum;
+        if (mMarker + 5 < mEnd && !mOverflow) {
+            *mMarker++ = '*';
+            *mMarker++ = hex[checksum >> 4];
+            *mMarker++ = hex[checksum & 0xF];
+            *mMarker++ = '\r';
+            *mMarker++ = '\n';
+            *mMarker = '\0';
+            return mMarker - mSentence;
+        }
+        LOC_LOGE("NMEA Error in string formatting");
+        return -1;
+    }
+};
+
+/*===========================================================================
+FUNCTION    loc_nmea_next_sentence
+
+DESCRIPTION
+   Get the room for the next sentence in the sentences buffer
 
 DEPENDENCIES
    NONE
 
 RETURN VALUE
-   Total length of the nmea sentence
+   Sentence of NMEA_SENTENCE_MAX_LENGTH bytes; NULL if the buffer is full
 
 SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-static int loc_nmea_put_checksum(char *pNmea, int maxSize)
+static char* loc_nmea_next_sentence(LocNmeaSentences &nmeaSentences)
 {
-    uint8_t checksum = 0;
-    int length = 0;
-    if(NULL == pNmea)
-        return 0;
+    char* sentence = nmeaSentences.next();
+    if (NULL == sentence)
+    {
+        LOC_LOGE("NMEA Error too many sentences");
+    }
+    return sentence;
+}
 
-    pNmea++; //skip the $
-    while (*pNmea != '\0')
+/*===========================================================================
+FUNCTION    loc_nmea_commit_sentence
+
+DESCRIPTION
+   Finish the sentence with its checksum, and add it to the sentences buffer
+
+DEPENDENCIES
+   NONE
+
+RETURN VALUE
+   NONE
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static void loc_nmea_commit_sentence(LocNmeaWriter &writer, LocNmeaSentences &nmeaSentences)
+{
+    int length = writer.finish();
+    if (length > 0)
     {
-        checksum ^= *pNmea++;
-        length++;
+        nmeaSentences.commit(length);
     }
+}
+
+/*===========================================================================
+FUNCTION    loc_nmea_add_sentence
+
+DESCRIPTION
+   Add a fixed sentence, with its checksum, to the sentences buffer
 
-    // length now contains nmea sentence string length not including $ sign.
-    int checksumLength = snprintf(pNmea,(maxSize-length-1),"*%02X\r\n", checksum);
+DEPENDENCIES
+   NONE
+
+RETURN VALUE
+   NONE
+
+SIDE EFFECTS
+   N/A
 
-    // total length of nmea sentence is length of nmea sentence inc $ sign plus
-    // length of checksum (+1 is to cover the $ character in the length).
-    return (length + checksumLength + 1);
+===========================================================================*/
+static void loc_nmea_add_sentence(const char* text, LocNmeaSentences &nmeaSentences)
+{
+    char* sentence = loc_nmea_next_sentence(nmeaSentences);
+    if (NULL != sentence)
+    {
+        LocNmeaWriter writer(sentence, NMEA_SENTENCE_MAX_LENGTH);
+        // text includes the $
+        writer.putStr(text + 1);
+        loc_nmea_commit_sentence(writer, nmeaSentences);
+    }
 }
 
 /*===========================================================================
@@ -218,21 +373,15 @@ SIDE EFFECTS
 
 ===========================================================================*/
 static uint32_t loc_nmea_generate_GSA(const GpsLocationExtended &locationExtended,
-                              char* sentence,
-                              int bufSize,
                               loc_nmea_sv_meta* sv_meta_p,
-                              std::vector<std::string> &nmeaArraystr)
+                              LocNmeaSentences &nmeaSentences)
 {
-    if (!sentence || bufSize <= 0 || !sv_meta_p)
+    if (!sv_meta_p)
     {
         LOC_LOGE("NMEA Error invalid arguments.");
         return 0;
     }
 
-    char* pMarker = sentence;
-    int lengthRemaining = bufSize;
-    int length = 0;
-
     uint32_t svUsedCount = 0;
     uint32_t svUsedList[32] = {0};
 
@@ -252,6 +401,11 @@ static uint32_t loc_nmea_generate_GSA(const GpsLocationExtended &locationExtende
     if (svUsedCount == 0 && GNSS_SV_TYPE_GPS != sv_meta_p->svType)
         return 0;
 
+    char* sentence = loc_nmea_next_sentence(nmeaSentences);
+    if (NULL == sentence)
+        return 0;
+    LocNmeaWriter writer(sentence, NMEA_SENTENCE_MAX_LENGTH);
+
     if (svUsedCount == 0)
         fixType = '1'; // no fix
     else if (svUsedCount <= 3)
@@ -268,56 +422,39 @@ static uint32_t loc_nmea_generate_GSA(const GpsLocationExtended &locationExtende
     // h.h : Horizontal DOP
     // v.v : Vertical DOP
     // cc : Checksum value
-    length = snprintf(pMarker, lengthRemaining, "$%sGSA,A,%c,", talker, fixType);
-
-    if (length < 0 || length >= lengthRemaining)
-    {
-        LOC_LOGE("NMEA Error in string formatting");
-        return 0;
-    }
-    pMarker += length;
-    lengthRemaining -= length;
+    writer.putStr(talker);
+    writer.putStr("GSA,A,");
+    writer.putChar(fixType);
+    writer.putChar(',');
 
     // Add first 12 satellite IDs
     for (uint8_t i = 0; i < 12; i++)
     {
         if (i < svUsedCount)
-            length = snprintf(pMarker, lengthRemaining, "%02d,", svUsedList[i]);
-        else
-            length = snprintf(pMarker, lengthRemaining, ",");
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return 0;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+            writer.putInt(svUsedList[i], 2);
+        writer.putChar(',');
     }
 
     // Add the position/horizontal/vertical DOP values
     if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DOP)
     {
-        length = snprintf(pMarker, lengthRemaining, "%.1f,%.1f,%.1f,",
-                locationExtended.pdop,
-                locationExtended.hdop,
-                locationExtended.vdop);
+        writer.putFixed(locationExtended.pdop, 1);
+        writer.putChar(',');
+        writer.putFixed(locationExtended.hdop, 1);
+        writer.putChar(',');
+        writer.putFixed(locationExtended.vdop, 1);
+        writer.putChar(',');
     }
     else
     {   // no dop
-        length = snprintf(pMarker, lengthRemaining, ",,,");
+        writer.putStr(",,,");
     }
-    pMarker += length;
-    lengthRemaining -= length;
 
     // system id
-    length = snprintf(pMarker, lengthRemaining, "%d", sv_meta_p->systemId);
-    pMarker += length;
-    lengthRemaining -= length;
+    writer.putInt(sv_meta_p->systemId);
 
     /* Sentence is ready, add checksum and broadcast */
-    length = loc_nmea_put_checksum(sentence, bufSize);
-    nmeaArraystr.push_back(sentence);
+    loc_nmea_commit_sentence(writer, nmeaSentences);
 
     return svUsedCount;
 }
@@ -343,20 +480,16 @@ SIDE EFFECTS
 
 ===========================================================================*/
 static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
-                              char* sentence,
-                              int bufSize,
                               loc_nmea_sv_meta* sv_meta_p,
-                              std::vector<std::string> &nmeaArraystr)
+                              LocNmeaSentences &nmeaSentences)
 {
-    if (!sentence || bufSize <= 0)
+    if (!sv_meta_p)
     {
         LOC_LOGE("NMEA Error invalid argument.");
         return;
     }
 
-    char* pMarker = sentence;
-    int lengthRemaining = bufSize;
-    int length = 0;
+    char* sentence = NULL;
     int sentenceCount = 0;
     int sentenceNumber = 1;
     size_t svNumber = 1;
@@ -368,9 +501,13 @@ static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
     if (svCount <= 0)
     {
         // no svs in view, so just send a blank $--GSV sentence
-        snprintf(sentence, lengthRemaining, "$%sGSV,1,1,0,", talker);
-        length = loc_nmea_put_checksum(sentence, bufSize);
-        nmeaArraystr.push_back(sentence);
+        sentence = loc_nmea_next_sentence(nmeaSentences);
+        if (NULL == sentence)
+            return;
+        LocNmeaWriter writer(sentence, NMEA_SENTENCE_MAX_LENGTH);
+        writer.putStr(talker);
+        writer.putStr("GSV,1,1,0,");
+        loc_nmea_commit_sentence(writer, nmeaSentences);
         return;
     }
 
@@ -380,49 +517,34 @@ static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
 
     while (sentenceNumber <= sentenceCount)
     {
-        pMarker = sentence;
-        lengthRemaining = bufSize;
-
-        length = snprintf(pMarker, lengthRemaining, "$%sGSV,%d,%d,%02d",
-                talker, sentenceCount, sentenceNumber, svCount);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
+        sentence = loc_nmea_next_sentence(nmeaSentences);
+        if (NULL == sentence)
             return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        LocNmeaWriter writer(sentence, NMEA_SENTENCE_MAX_LENGTH);
+
+        writer.putStr(talker);
+        writer.putStr("GSV,");
+        writer.putInt(sentenceCount);
+        writer.putChar(',');
+        writer.putInt(sentenceNumber);
+        writer.putChar(',');
+        writer.putInt(svCount, 2);
 
         for (int i=0; (svNumber <= svNotify.count) && (i < 4);  svNumber++)
         {
             if (sv_meta_p->svType == svNotify.gnssSvs[svNumber - 1].type)
             {
-                length = snprintf(pMarker, lengthRemaining,",%02d,%02d,%03d,",
-                        svNotify.gnssSvs[svNumber - 1].svId + svIdOffset,
-                        (int)(0.5 + svNotify.gnssSvs[svNumber - 1].elevation), //float to int
-                        (int)(0.5 + svNotify.gnssSvs[svNumber - 1].azimuth)); //float to int
-
-                if (length < 0 || length >= lengthRemaining)
-                {
-                    LOC_LOGE("NMEA Error in string formatting");
-                    return;
-                }
-                pMarker += length;
-                lengthRemaining -= length;
+                writer.putChar(',');
+                writer.putInt(svNotify.gnssSvs[svNumber - 1].svId + svIdOffset, 2);
+                writer.putChar(',');
+                writer.putInt((int)(0.5 + svNotify.gnssSvs[svNumber - 1].elevation), 2); //float to int
+                writer.putChar(',');
+                writer.putInt((int)(0.5 + svNotify.gnssSvs[svNumber - 1].azimuth), 3); //float to int
+                writer.putChar(',');
 
                 if (svNotify.gnssSvs[svNumber - 1].cN0Dbhz > 0)
                 {
-                    length = snprintf(pMarker, lengthRemaining,"%02d",
-                            (int)(0.5 + svNotify.gnssSvs[svNumber - 1].cN0Dbhz)); //float to int
-
-                    if (length < 0 || length >= lengthRemaining)
-                    {
-                        LOC_LOGE("NMEA Error in string formatting");
-                        return;
-                    }
-                    pMarker += length;
-                    lengthRemaining -= length;
+                    writer.putInt((int)(0.5 + svNotify.gnssSvs[svNumber - 1].cN0Dbhz), 2); //float to int
                 }
 
                 i++;
@@ -435,20 +557,105 @@ static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
             (sv_meta_p->svType == GNSS_SV_TYPE_BEIDOU))
         {
             // last one is System id and second last is Signal Id which is always zero
-            length = snprintf(pMarker, lengthRemaining,",%d,%d",0,sv_meta_p->systemId);
-            pMarker += length;
-            lengthRemaining -= length;
+            writer.putStr(",0,");
+            writer.putInt(sv_meta_p->systemId);
         }
 
-        length = loc_nmea_put_checksum(sentence, bufSize);
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_commit_sentence(writer, nmeaSentences);
         sentenceNumber++;
 
     }  //while
 }
 
 /*===========================================================================
-FUNCTION    loc_nmea_generate_pos
+FUNCTION    loc_nmea_put_lat_long
+
+DESCRIPTION
+   Write the latitude and longitude fields of RMC and GGA sentences, as
+   "%02d%09.6lf,%c,%03d%09.6lf,%c,"
+
+DEPENDENCIES
+   NONE
+
+RETURN VALUE
+   NONE
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static void loc_nmea_put_lat_long(LocNmeaWriter &writer, const UlpLocation &location)
+{
+    double latitude = location.gpsLocation.latitude;
+    double longitude = location.gpsLocation.longitude;
+    char latHemisphere;
+    char lonHemisphere;
+    double latMinutes;
+    double lonMinutes;
+
+    if (latitude > 0)
+    {
+        latHemisphere = 'N';
+    }
+    else
+    {
+        latHemisphere = 'S';
+        latitude *= -1.0;
+    }
+
+    if (longitude < 0)
+    {
+        lonHemisphere = 'W';
+        longitude *= -1.0;
+    }
+    else
+    {
+        lonHemisphere = 'E';
+    }
+
+    latMinutes = fmod(latitude * 60.0 , 60.0);
+    lonMinutes = fmod(longitude * 60.0 , 60.0);
+
+    writer.putInt((uint8_t)floor(latitude), 2);
+    writer.putFixed(latMinutes, 6, 9);
+    writer.putChar(',');
+    writer.putChar(latHemisphere);
+    writer.putChar(',');
+    writer.putInt((uint8_t)floor(longitude), 3);
+    writer.putFixed(lonMinutes, 6, 9);
+    writer.putChar(',');
+    writer.putChar(lonHemisphere);
+    writer.putChar(',');
+}
+
+/*===========================================================================
+FUNCTION    loc_nmea_put_utc_time
+
+DESCRIPTION
+   Write the UTC time field of RMC and GGA sentences, as "%02d%02d%02d.%02d,"
+
+DEPENDENCIES
+   NONE
+
+RETURN VALUE
+   NONE
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static void loc_nmea_put_utc_time(LocNmeaWriter &writer, const tm &utcTm, int utcMSeconds)
+{
+    writer.putInt(utcTm.tm_hour, 2);
+    writer.putInt(utcTm.tm_min, 2);
+    writer.putInt(utcTm.tm_sec, 2);
+    writer.putChar('.');
+    writer.putInt(utcMSeconds / 10, 2);
+    writer.putChar(',');
+}
+
+/*===========================================================================
+FUNCTION    NmeaContext::generatePos
 
 DESCRIPTION
    Generate NMEA sentences generated based on position report
@@ -471,29 +678,26 @@ SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-void loc_nmea_generate_pos(const UlpLocation &location,
-                               const GpsLocationExtended &locationExtended,
-                               unsigned char generate_nmea,
-                               std::vector<std::string> &nmeaArraystr)
+void NmeaContext::generatePos(const UlpLocation &location,
+                              const GpsLocationExtended &locationExtended,
+                              unsigned char generate_nmea)
 {
     ENTRY_LOG();
+    loc_sv_cache_info& sv_cache_info = mSvCache;
+    LocNmeaSentences& nmeaSentences = mSentences;
+    nmeaSentences.clear();
     time_t utcTime(location.gpsLocation.timestamp/1000);
-    tm * pTm = gmtime(&utcTime);
+    struct tm utcTm;
+    tm * pTm = gmtime_r(&utcTime, &utcTm);
     if (NULL == pTm) {
         LOC_LOGE("gmtime failed");
         return;
     }
 
-    char sentence[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char* pMarker = sentence;
-    int lengthRemaining = sizeof(sentence);
-    int length = 0;
+    char* sentence = NULL;
     int utcYear = pTm->tm_year % 100; // 2 digit year
     int utcMonth = pTm->tm_mon + 1; // tm_mon starts at zero
     int utcDay = pTm->tm_mday;
-    int utcHours = pTm->tm_hour;
-    int utcMinutes = pTm->tm_min;
-    int utcSeconds = pTm->tm_sec;
     int utcMSeconds = (location.gpsLocation.timestamp)%1000;
 
     if (generate_nmea) {
@@ -505,8 +709,8 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GPGSA/$GNGSA---
         // -------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
-                loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_GPS, true), nmeaArraystr);
+        count = loc_nmea_generate_GSA(locationExtended,
+                loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_GPS, true), nmeaSentences);
         if (count > 0)
         {
             svUsedCount += count;
@@ -518,8 +722,8 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GLGSA/$GNGSA---
         // -------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
-                loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_GLONASS, true), nmeaArraystr);
+        count = loc_nmea_generate_GSA(locationExtended,
+                loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_GLONASS, true), nmeaSentences);
         if (count > 0)
         {
             svUsedCount += count;
@@ -531,8 +735,8 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GAGSA/$GNGSA---
         // -------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
-                loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_GALILEO, true), nmeaArraystr);
+        count = loc_nmea_generate_GSA(locationExtended,
+                loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_GALILEO, true), nmeaSentences);
         if (count > 0)
         {
             svUsedCount += count;
@@ -544,8 +748,8 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$PQGSA/$GNGSA (QZSS)---
         // --------------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
-                loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_QZSS, false), nmeaArraystr);
+        count = loc_nmea_generate_GSA(locationExtended,
+                loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_QZSS, false), nmeaSentences);
         if (count > 0)
         {
             svUsedCount += count;
@@ -555,8 +759,8 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ----------------------------
         // ---$PQGSA/$GNGSA (BEIDOU)---
         // ----------------------------
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
-                loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_BEIDOU, false), nmeaArraystr);
+        count = loc_nmea_generate_GSA(locationExtended,
+                loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_BEIDOU, false), nmeaSentences);
         if (count > 0)
         {
             svUsedCount += count;
@@ -567,9 +771,12 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ------$--VTG-------
         // -------------------
 
-        pMarker = sentence;
-        lengthRemaining = sizeof(sentence);
+        sentence = loc_nmea_next_sentence(nmeaSentences);
+        if (NULL == sentence)
+            return;
+        LocNmeaWriter vtg(sentence, NMEA_SENTENCE_MAX_LENGTH);
 
+        vtg.putStr(talker);
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_BEARING)
         {
             float magTrack = location.gpsLocation.bearing;
@@ -582,168 +789,86 @@ void loc_nmea_generate_pos(const UlpLocation &location,
                     magTrack -= 360.0;
             }
 
-            length = snprintf(pMarker, lengthRemaining, "$%sVTG,%.1lf,T,%.1lf,M,", talker, location.gpsLocation.bearing, magTrack);
+            vtg.putStr("VTG,");
+            vtg.putFixed(location.gpsLocation.bearing, 1);
+            vtg.putStr(",T,");
+            vtg.putFixed(magTrack, 1);
+            vtg.putStr(",M,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, "$%sVTG,,T,,M,", talker);
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            vtg.putStr("VTG,,T,,M,");
         }
-        pMarker += length;
-        lengthRemaining -= length;
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_SPEED)
         {
             float speedKnots = location.gpsLocation.speed * (3600.0/1852.0);
             float speedKmPerHour = location.gpsLocation.speed * 3.6;
 
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,N,%.1lf,K,", speedKnots, speedKmPerHour);
+            vtg.putFixed(speedKnots, 1);
+            vtg.putStr(",N,");
+            vtg.putFixed(speedKmPerHour, 1);
+            vtg.putStr(",K,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, ",N,,K,");
+            vtg.putStr(",N,,K,");
         }
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
         if (!(location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG))
             // N means no fix
-            length = snprintf(pMarker, lengthRemaining, "%c", 'N');
+            vtg.putChar('N');
         else if (LOC_NAV_MASK_SBAS_CORRECTION_IONO & locationExtended.navSolutionMask)
             // D means differential
-            length = snprintf(pMarker, lengthRemaining, "%c", 'D');
+            vtg.putChar('D');
         else if (LOC_POS_TECH_MASK_SENSORS == locationExtended.tech_mask)
             // E means estimated (dead reckoning)
-            length = snprintf(pMarker, lengthRemaining, "%c", 'E');
+            vtg.putChar('E');
         else // A means autonomous
-            length = snprintf(pMarker, lengthRemaining, "%c", 'A');
+            vtg.putChar('A');
 
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_commit_sentence(vtg, nmeaSentences);
 
         // -------------------
         // ------$--RMC-------
         // -------------------
 
-        pMarker = sentence;
-        lengthRemaining = sizeof(sentence);
-
-        length = snprintf(pMarker, lengthRemaining, "$%sRMC,%02d%02d%02d.%02d,A," ,
-                          talker, utcHours, utcMinutes, utcSeconds,utcMSeconds/10);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
+        sentence = loc_nmea_next_sentence(nmeaSentences);
+        if (NULL == sentence)
             return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        LocNmeaWriter rmc(sentence, NMEA_SENTENCE_MAX_LENGTH);
+
+        rmc.putStr(talker);
+        rmc.putStr("RMC,");
+        loc_nmea_put_utc_time(rmc, *pTm, utcMSeconds);
+        rmc.putStr("A,");
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG)
         {
-            double latitude = location.gpsLocation.latitude;
-            double longitude = location.gpsLocation.longitude;
-            char latHemisphere;
-            char lonHemisphere;
-            double latMinutes;
-            double lonMinutes;
-
-            if (latitude > 0)
-            {
-                latHemisphere = 'N';
-            }
-            else
-            {
-                latHemisphere = 'S';
-                latitude *= -1.0;
-            }
-
-            if (longitude < 0)
-            {
-                lonHemisphere = 'W';
-                longitude *= -1.0;
-            }
-            else
-            {
-                lonHemisphere = 'E';
-            }
-
-            latMinutes = fmod(latitude * 60.0 , 60.0);
-            lonMinutes = fmod(longitude * 60.0 , 60.0);
-
-            length = snprintf(pMarker, lengthRemaining, "%02d%09.6lf,%c,%03d%09.6lf,%c,",
-                              (uint8_t)floor(latitude), latMinutes, latHemisphere,
-                              (uint8_t)floor(longitude),lonMinutes, lonHemisphere);
+            loc_nmea_put_lat_long(rmc, location);
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining,",,,,");
+            rmc.putStr(",,,,");
         }
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_SPEED)
         {
             float speedKnots = location.gpsLocation.speed * (3600.0/1852.0);
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,", speedKnots);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            rmc.putFixed(speedKnots, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
+        rmc.putChar(',');
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_BEARING)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,", location.gpsLocation.bearing);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
+            rmc.putFixed(location.gpsLocation.bearing, 1);
         }
+        rmc.putChar(',');
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
-        length = snprintf(pMarker, lengthRemaining, "%2.2d%2.2d%2.2d,",
-                          utcDay, utcMonth, utcYear);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        rmc.putInt(utcDay, 2);
+        rmc.putInt(utcMonth, 2);
+        rmc.putInt(utcYear, 2);
+        rmc.putChar(',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_MAG_DEV)
         {
@@ -759,104 +884,52 @@ void loc_nmea_generate_pos(const UlpLocation &location,
                 direction = 'E';
             }
 
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,%c,",
-                              magneticVariation, direction);
+            rmc.putFixed(magneticVariation, 1);
+            rmc.putChar(',');
+            rmc.putChar(direction);
+            rmc.putChar(',');
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, ",,");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            rmc.putStr(",,");
         }
-        pMarker += length;
-        lengthRemaining -= length;
 
         if (!(location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG))
             // N means no fix
-            length = snprintf(pMarker, lengthRemaining, "%c", 'N');
+            rmc.putChar('N');
         else if (LOC_NAV_MASK_SBAS_CORRECTION_IONO & locationExtended.navSolutionMask)
             // D means differential
-            length = snprintf(pMarker, lengthRemaining, "%c", 'D');
+            rmc.putChar('D');
         else if (LOC_POS_TECH_MASK_SENSORS == locationExtended.tech_mask)
             // E means estimated (dead reckoning)
-            length = snprintf(pMarker, lengthRemaining, "%c", 'E');
+            rmc.putChar('E');
         else  // A means autonomous
-            length = snprintf(pMarker, lengthRemaining, "%c", 'A');
+            rmc.putChar('A');
 
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_commit_sentence(rmc, nmeaSentences);
 
         // -------------------
         // ------$--GGA-------
         // -------------------
 
-        pMarker = sentence;
-        lengthRemaining = sizeof(sentence);
-
-        length = snprintf(pMarker, lengthRemaining, "$%sGGA,%02d%02d%02d.%02d," ,
-                          talker, utcHours, utcMinutes, utcSeconds, utcMSeconds/10);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
+        sentence = loc_nmea_next_sentence(nmeaSentences);
+        if (NULL == sentence)
             return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        LocNmeaWriter gga(sentence, NMEA_SENTENCE_MAX_LENGTH);
+
+        gga.putStr(talker);
+        gga.putStr("GGA,");
+        loc_nmea_put_utc_time(gga, *pTm, utcMSeconds);
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG)
         {
-            double latitude = location.gpsLocation.latitude;
-            double longitude = location.gpsLocation.longitude;
-            char latHemisphere;
-            char lonHemisphere;
-            double latMinutes;
-            double lonMinutes;
-
-            if (latitude > 0)
-            {
-                latHemisphere = 'N';
-            }
-            else
-            {
-                latHemisphere = 'S';
-                latitude *= -1.0;
-            }
-
-            if (longitude < 0)
-            {
-                lonHemisphere = 'W';
-                longitude *= -1.0;
-            }
-            else
-            {
-                lonHemisphere = 'E';
-            }
-
-            latMinutes = fmod(latitude * 60.0 , 60.0);
-            lonMinutes = fmod(longitude * 60.0 , 60.0);
-
-            length = snprintf(pMarker, lengthRemaining, "%02d%09.6lf,%c,%03d%09.6lf,%c,",
-                              (uint8_t)floor(latitude), latMinutes, latHemisphere,
-                              (uint8_t)floor(longitude),lonMinutes, lonHemisphere);
+            loc_nmea_put_lat_long(gga, location);
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining,",,,,");
+            gga.putStr(",,,,");
         }
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
         char gpsQuality;
         if (!(location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG))
             gpsQuality = '0'; // 0 means no fix
@@ -870,56 +943,39 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // Number of satellites in use, 00-12
         if (svUsedCount > MAX_SATELLITES_IN_USE)
             svUsedCount = MAX_SATELLITES_IN_USE;
+        gga.putChar(gpsQuality);
+        gga.putChar(',');
+        gga.putInt(svUsedCount, 2);
+        gga.putChar(',');
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DOP)
         {
-            length = snprintf(pMarker, lengthRemaining, "%c,%02d,%.1f,",
-                              gpsQuality, svUsedCount, locationExtended.hdop);
-        }
-        else
-        {   // no hdop
-            length = snprintf(pMarker, lengthRemaining, "%c,%02d,,",
-                              gpsQuality, svUsedCount);
+            gga.putFixed(locationExtended.hdop, 1);
         }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        // else no hdop
+        gga.putChar(',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,M,",
-                              locationExtended.altitudeMeanSeaLevel);
+            gga.putFixed(locationExtended.altitudeMeanSeaLevel, 1);
+            gga.putStr(",M,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining,",,");
+            gga.putStr(",,");
         }
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
         if ((location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_ALTITUDE) &&
             (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL))
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,M,,",
-                              location.gpsLocation.altitude - locationExtended.altitudeMeanSeaLevel);
+            gga.putFixed(location.gpsLocation.altitude - locationExtended.altitudeMeanSeaLevel, 1);
+            gga.putStr(",M,,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining,",,,");
+            gga.putStr(",,,");
         }
 
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_commit_sentence(gga, nmeaSentences);
 
         // clear the cache so they can't be used again
         sv_cache_info.gps_used_mask = 0;
@@ -930,29 +986,12 @@ void loc_nmea_generate_pos(const UlpLocation &location,
     }
     //Send blank NMEA reports for non-final fixes
     else {
-        strlcpy(sentence, "$GPGSA,A,1,,,,,,,,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GNGSA,A,1,,,,,,,,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$PQGSA,A,1,,,,,,,,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPVTG,,T,,M,,N,,K,N", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPRMC,,V,,,,,,,,,,N", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPGGA,,,,,,0,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_add_sentence("$GPGSA,A,1,,,,,,,,,,,,,,,", nmeaSentences);
+        loc_nmea_add_sentence("$GNGSA,A,1,,,,,,,,,,,,,,,", nmeaSentences);
+        loc_nmea_add_sentence("$PQGSA,A,1,,,,,,,,,,,,,,,", nmeaSentences);
+        loc_nmea_add_sentence("$GPVTG,,T,,M,,N,,K,N", nmeaSentences);
+        loc_nmea_add_sentence("$GPRMC,,V,,,,,,,,,,N", nmeaSentences);
+        loc_nmea_add_sentence("$GPGGA,,,,,,0,,,,,,,,", nmeaSentences);
     }
 
     EXIT_LOG(%d, 0);
@@ -961,33 +1000,26 @@ void loc_nmea_generate_pos(const UlpLocation &location,
 
 
 /*===========================================================================
-FUNCTION    loc_nmea_generate_sv
+FUNCTION    NmeaContext::updateSvCache
 
 DESCRIPTION
-   Generate NMEA sentences generated based on sv report
+   Cache the SVs used in fix and the SV counts of a sv report, which the
+   $--GSA sentences of the next position report are generated from
 
 DEPENDENCIES
    NONE
 
 RETURN VALUE
-   0
+   None
 
 SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
-                              std::vector<std::string> &nmeaArraystr)
+void NmeaContext::updateSvCache(const GnssSvNotification &svNotify)
 {
-    ENTRY_LOG();
-
-    char sentence[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char* pMarker = sentence;
-    int lengthRemaining = sizeof(sentence);
-    int length = 0;
+    loc_sv_cache_info& sv_cache_info = mSvCache;
     int svCount = svNotify.count;
-    int sentenceCount = 0;
-    int sentenceNumber = 1;
     int svNumber = 1;
 
     //Count GPS SVs for saparating GPS from GLONASS and throw others
@@ -1065,42 +1097,120 @@ void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
             sv_cache_info.bds_count++;
         }
     }
+}
+
+/*===========================================================================
+FUNCTION    NmeaContext::generateSv
+
+DESCRIPTION
+   Generate NMEA sentences generated based on sv report
+
+DEPENDENCIES
+   NONE
+
+RETURN VALUE
+   0
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+void NmeaContext::generateSv(const GnssSvNotification &svNotify)
+{
+    ENTRY_LOG();
+    loc_sv_cache_info& sv_cache_info = mSvCache;
+    LocNmeaSentences& nmeaSentences = mSentences;
+    nmeaSentences.clear();
+
+    updateSvCache(svNotify);
 
     loc_nmea_sv_meta sv_meta;
     // ------------------
     // ------$GPGSV------
     // ------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
-            loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_GPS, false), nmeaArraystr);
+    loc_nmea_generate_GSV(svNotify,
+            loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_GPS, false), nmeaSentences);
 
     // ------------------
     // ------$GLGSV------
     // ------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
-            loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_GLONASS, false), nmeaArraystr);
+    loc_nmea_generate_GSV(svNotify,
+            loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_GLONASS, false), nmeaSentences);
 
     // ------------------
     // ------$GAGSV------
     // ------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
-            loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_GALILEO, false), nmeaArraystr);
+    loc_nmea_generate_GSV(svNotify,
+            loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_GALILEO, false), nmeaSentences);
 
     // -------------------------
     // ------$PQGSV (QZSS)------
     // -------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
-            loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_QZSS, false), nmeaArraystr);
+    loc_nmea_generate_GSV(svNotify,
+            loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_QZSS, false), nmeaSentences);
 
     // ---------------------------
     // ------$PQGSV (BEIDOU)------
     // ---------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
-            loc_nmea_sv_meta_init(sv_meta, GNSS_SV_TYPE_BEIDOU, false), nmeaArraystr);
+    loc_nmea_generate_GSV(svNotify,
+            loc_nmea_sv_meta_init(sv_cache_info, sv_meta, GNSS_SV_TYPE_BEIDOU, false), nmeaSentences);
 
     EXIT_LOG(%d, 0);
 }
+
+/*===========================================================================
+FUNCTION    loc_nmea_append_sentences
+
+DESCRIPTION
+   Append each of the generated sentences as a string to nmeaArraystr, for
+   loc_nmea_generate_pos / loc_nmea_generate_sv. These share one context,
+   so that the SV info of loc_nmea_generate_sv is used by the next
+   loc_nmea_generate_pos, as before contexts were introduced.
+
+DEPENDENCIES
+   NONE
+
+RETURN VALUE
+   NONE
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static NmeaContext sDefaultNmeaContext;
+static pthread_mutex_t sDefaultNmeaContextMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void loc_nmea_append_sentences(const LocNmeaSentences &nmeaSentences,
+                                      std::vector<std::string> &nmeaArraystr)
+{
+    for (uint32_t i = 0; i < nmeaSentences.count(); i++)
+    {
+        nmeaArraystr.push_back(std::string(nmeaSentences.sentence(i),
+                                           nmeaSentences.length(i)));
+    }
+}
+
+void loc_nmea_generate_pos(const UlpLocation &location,
+                               const GpsLocationExtended &locationExtended,
+                               unsigned char generate_nmea,
+                               std::vector<std::string> &nmeaArraystr)
+{
+    pthread_mutex_lock(&sDefaultNmeaContextMutex);
+    sDefaultNmeaContext.generatePos(location, locationExtended, generate_nmea);
+    loc_nmea_append_sentences(sDefaultNmeaContext.getSentences(), nmeaArraystr);
+    pthread_mutex_unlock(&sDefaultNmeaContextMutex);
+}
+
+void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
+                              std::vector<std::string> &nmeaArraystr)
+{
+    pthread_mutex_lock(&sDefaultNmeaContextMutex);
+    sDefaultNmeaContext.generateSv(svNotify);
+    loc_nmea_append_sentences(sDefaultNmeaContext.getSentences(), nmeaArraystr);
+    pthread_mutex_unlock(&sDefaultNmeaContextMutex);
+}
@@ -34,7 +34,80 @@
 #include <vector>
 #include <string>
 #define NMEA_SENTENCE_MAX_LENGTH 200
+// enough for the GSV sentences of GNSS_SV_MAX SVs in 5 constellations
+#define NMEA_SENTENCES_MAX 32
 
+// The NMEA sentences of one report, generated back to back into one
+// contiguous buffer. Each sentence is NUL terminated in place, and is
+// handed out as a pointer / length view into the buffer. The obj can be
+// kept and reused for every report, so that generation does not allocate.
+class LocNmeaSentences {
+    char mBuffer[NMEA_SENTENCES_MAX * NMEA_SENTENCE_MAX_LENGTH];
+    uint16_t mOffsets[NMEA_SENTENCES_MAX];
+    uint16_t mLengths[NMEA_SENTENCES_MAX];
+    uint32_t mCount;
+    uint32_t mUsed;
+public:
+    inline LocNmeaSentences() : mCount(0), mUsed(0) {}
+    inline void clear() { mCount = 0; mUsed = 0; }
+    inline uint32_t count() const { return mCount; }
+    inline const char* sentence(uint32_t i) const { return mBuffer + mOffsets[i]; }
+    inline size_t length(uint32_t i) const { return mLengths[i]; }
+    // room of NMEA_SENTENCE_MAX_LENGTH bytes to write the next sentence
+    // into; NULL if the buffer is full.
+    inline char* next() {
+        return (mCount < NMEA_SENTENCES_MAX) ? (mBuffer + mUsed) : NULL;
+    }
+    // adds the sentence written into next(), of length excluding the NUL
+    inline void commit(int length) {
+        mOffsets[mCount] = mUsed;
+        mLengths[mCount] = length;
+        mCount++;
+        mUsed += length + 1;
+    }
+};
+
+// SV info of the last sv report, cached for the GSA sentences of the
+// following position report
+typedef struct loc_sv_cache_info_s
+{
+    uint32_t gps_used_mask;
+    uint32_t glo_used_mask;
+    uint32_t gal_used_mask;
+    uint32_t qzss_used_mask;
+    uint32_t bds_used_mask;
+    uint32_t gps_count;
+    uint32_t glo_count;
+    uint32_t gal_count;
+    uint32_t qzss_count;
+    uint32_t bds_count;
+    float hdop;
+    float pdop;
+    float vdop;
+} loc_sv_cache_info;
+
+// All the state of one NMEA generating session: the SV cache carried from
+// an sv report to the next position report, and the buffer the sentences
+// are generated into. Each engine, e.g. AP generated NMEA or a replay,
+// keeps its own context, and different contexts can be used concurrently.
+// A context itself is not thread safe.
+class NmeaContext {
+    loc_sv_cache_info mSvCache;
+    LocNmeaSentences mSentences;
+public:
+    inline NmeaContext() : mSvCache(), mSentences() {}
+    // the sentences of the last generatePos() / generateSv() call, valid
+    // until the next call
+    inline const LocNmeaSentences& getSentences() const { return mSentences; }
+    // only caches the SVs for the next generatePos(), without the sentences
+    void updateSvCache(const GnssSvNotification &svNotify);
+    void generateSv(const GnssSvNotification &svNotify);
+    void generatePos(const UlpLocation &location,
+                     const GpsLocationExtended &locationExtended,
+                     unsigned char generate_nmea);
+};
+
+// same as NmeaContext, on a context shared by all callers of these
 void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
                               std::vector<std::string> &nmeaArraystr);
 
@@ -157,6 +157,32 @@ SIDE EFFECTS
 ===========================================================================*/
 msq_q_err_type msg_q_rcv(void* msg_q_data, void** msg_obj);
 
+/*===========================================================================
+FUNCTION    msg_q_rcv_all
+
+DESCRIPTION
+   Retrieves all data from the message queue at once. Blocks until there is
+   at least one message, then exchanges the message queue's internal list
+   with the one passed in, all under a single lock acquisition. Messages are
+   then taken off the returned list with linked_list_remove(), oldest first,
+   without touching the message queue again.
+
+   msg_q_data: Message Queue to retrieve data from.
+   msg_list:   In: handle to an empty list created with linked_list_init().
+               Out: handle to the list holding all the received messages.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+msq_q_err_type msg_q_rcv_all(void* msg_q_data, void** msg_list);
+
 /*===========================================================================
 FUNCTION    msg_q_flush
 